@@ -0,0 +1,19 @@
+/*
+ * io.h
+ *
+ * Created: 16/10/2026 9:02:11 AM
+ */
+
+//Host stand-in for <avr/io.h>.
+//libmodule only relies on it for the fixed width integer types, so there are no register definitions here.
+
+#pragma once
+
+//Any translation unit that picks up the host headers is a host build
+#ifndef LIBMODULE_HOST
+#define LIBMODULE_HOST
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
@@ -0,0 +1,34 @@
+/*
+ * pgmspace.h
+ *
+ * Created: 16/10/2026 9:04:37 AM
+ */
+
+//Host stand-in for <avr/pgmspace.h>.
+//The host has a single address space, so program memory is ordinary (read-only) memory.
+
+#pragma once
+
+#include <string.h>
+#include "io.h"
+
+#define PROGMEM
+#define PGM_P char const *
+#define PSTR(s) (s)
+
+inline void *memcpy_P(void *const dest, void const *const src, size_t const len)
+{
+    return memcpy(dest, src, len);
+}
+
+inline uint8_t pgm_read_byte(void const *const addr)
+{
+    return *static_cast<uint8_t const *>(addr);
+}
+
+inline uint16_t pgm_read_word(void const *const addr)
+{
+    uint16_t rtrn;
+    memcpy(&rtrn, addr, sizeof rtrn);
+    return rtrn;
+}
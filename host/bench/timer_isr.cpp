@@ -0,0 +1,88 @@
+/*
+ * timer_isr.cpp
+ *
+ * Created: 16/10/2026 11:42:08 PM
+ */
+
+//Time taken by one tick of the base timer daemon (TimerBase<1000>::handle_isr()), with 64 Timer1k and 8 Stopwatch1k.
+//The daemon isn't started: handle_isr() is called directly, so nothing else runs in between.
+//Idle ticks are timed together, and expiring ticks one at a time (see below).
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <libmodule.h>
+
+using namespace libmodule;
+
+namespace
+{
+    constexpr size_t timer_count = 64;
+    constexpr size_t stopwatch_count = 8;
+    constexpr size_t rounds = 20;
+    //Fewer than the ticks the idle timers are set to, so none of them expire in a round
+    constexpr size_t ticks = 20000;
+
+    void restart_timers(Timer1k (&timers)[timer_count], uint16_t const value)
+    {
+        for(auto &timer : timers) {
+            timer.reset();
+            timer = value;
+            timer.start();
+        }
+    }
+
+    double median(std::vector<double> &values)
+    {
+        std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+        return values[values.size() / 2];
+    }
+
+    double elapsed_ns(std::chrono::steady_clock::time_point const begin, std::chrono::steady_clock::time_point const end)
+    {
+        return std::chrono::duration<double, std::nano>(end - begin).count();
+    }
+}
+
+int main()
+{
+    //Constructed here rather than at namespace scope, so that the library's static objects already exist
+    static Timer1k timers[timer_count];
+    static Stopwatch1k stopwatches[stopwatch_count];
+    for(auto &stopwatch : stopwatches)
+        stopwatch.start();
+
+    //Every timer is running, and none are due: the ticks of a round are timed together
+    double idle = 1e12;
+    for(size_t round = 0; round < rounds; round++) {
+        restart_timers(timers, 60000);
+        auto const begin = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < ticks; i++)
+            time::TimerBase<1000>::handle_isr();
+        double const took = elapsed_ns(begin, std::chrono::steady_clock::now()) / ticks;
+        if(took < idle) idle = took;
+    }
+
+    //Every timer is due on the tick: the timers are restarted between ticks, so each tick is timed alone.
+    //The median is used, less the median time taken to read the clock, so that a tick that was preempted doesn't count.
+    std::vector<double> expiring_ticks, overheads;
+    for(size_t i = 0; i < ticks; i++) {
+        restart_timers(timers, 1);
+        auto const begin = std::chrono::steady_clock::now();
+        time::TimerBase<1000>::handle_isr();
+        auto const end = std::chrono::steady_clock::now();
+        expiring_ticks.push_back(elapsed_ns(begin, end));
+        auto const empty = std::chrono::steady_clock::now();
+        overheads.push_back(elapsed_ns(empty, std::chrono::steady_clock::now()));
+    }
+    double const expiring = median(expiring_ticks) - median(overheads);
+
+    printf("timers: %zu Timer1k (%zu B each), %zu Stopwatch1k (%zu B each)\n", timer_count, sizeof(Timer1k), stopwatch_count, sizeof(Stopwatch1k));
+    printf("idle tick:        %.1f ns\n", idle);
+    printf("%zu expiring tick: %.1f ns\n", timer_count, expiring);
+    return 0;
+}
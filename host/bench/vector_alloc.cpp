@@ -0,0 +1,78 @@
+/*
+ * vector_alloc.cpp
+ *
+ * Created: 16/10/2026 11:58:31 PM
+ */
+
+//Counts the allocator calls (pool_alloc, pool_realloc and pool_free) made by Vector and InstanceList, with LIBMODULE_HEAP_STATS.
+//On the microcontroller each call is a walk of the heap's free list with interrupts disabled, so the count matters more than the time taken here.
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <libmodule.h>
+
+#ifndef LIBMODULE_HEAP_STATS
+#error "vector_alloc needs LIBMODULE_HEAP_STATS"
+#endif
+
+using namespace libmodule;
+
+namespace
+{
+    constexpr uint8_t element_count = 200;
+    constexpr uint8_t instance_count = 50;
+    constexpr uint8_t instance_rounds = 10;
+
+    struct Instance : public utility::InstanceList<Instance> {};
+
+    uint32_t allocator_calls()
+    {
+        utility::HeapStats const stats = utility::heap_stats();
+        return stats.allocations + stats.reallocs + stats.frees;
+    }
+}
+
+int main()
+{
+    uint32_t calls = allocator_calls();
+    {
+        utility::Vector<uint16_t> vector;
+        for(uint8_t i = 0; i < element_count; i++)
+            vector.push_back(i);
+        while(vector.size() > 0)
+            vector.remove_pos(vector.size() - 1);
+    }
+    printf("push_back x%u, then remove_pos x%u: %u calls\n", element_count, element_count, static_cast<unsigned>(allocator_calls() - calls));
+
+    calls = allocator_calls();
+    for(uint8_t round = 0; round < instance_rounds; round++) {
+        Instance *instances[instance_count];
+        for(auto &instance : instances)
+            instance = new Instance;
+        for(auto instance : instances)
+            delete instance;
+    }
+    printf("%u rounds of %u InstanceList objects created and destroyed: %u calls (%u of them the objects' own new/delete)\n",
+           instance_rounds, instance_count, static_cast<unsigned>(allocator_calls() - calls), instance_rounds * instance_count * 2);
+
+    uint16_t source[element_count];
+    for(uint8_t i = 0; i < element_count; i++)
+        source[i] = i;
+
+    calls = allocator_calls();
+    {
+        utility::Vector<uint16_t> vector;
+        for(uint8_t i = 0; i < element_count; i++)
+            vector.push_back(source[i]);
+    }
+    printf("%u elements added with push_back: %u calls\n", element_count, static_cast<unsigned>(allocator_calls() - calls));
+
+    calls = allocator_calls();
+    {
+        utility::Vector<uint16_t> vector;
+        vector.append(source, element_count);
+    }
+    printf("%u elements added with append: %u calls\n", element_count, static_cast<unsigned>(allocator_calls() - calls));
+    return 0;
+}
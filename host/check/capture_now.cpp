@@ -0,0 +1,94 @@
+/*
+ * capture_now.cpp
+ *
+ * Created: 17/10/2026 11:20:36 AM
+ */
+
+//Checks that CaptureStopwatch::now() never goes backwards, and that it measures a known time.
+//In virtual time the clock is moved in steps that don't line up with the ticks. In real time it is read as fast as possible while the daemon thread ticks.
+//The clock is selected with the argument "virtual" or "realtime".
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <chrono>
+
+#include <libmodule.h>
+
+using namespace libmodule;
+
+namespace
+{
+    constexpr uint32_t virtual_steps = 100000;
+    constexpr uint64_t virtual_step_ns = 37000;
+    constexpr auto realtime_duration = std::chrono::milliseconds(300);
+
+    struct Reads {
+        uint32_t count = 0;
+        uint32_t backwards = 0;
+        time::CaptureStopwatch::us_t worst = 0;
+        time::CaptureStopwatch::us_t previous = 0;
+
+        void read() {
+            time::CaptureStopwatch::us_t const now = time::CaptureStopwatch::now();
+            if(count > 0 && static_cast<int32_t>(now - previous) < 0) {
+                backwards++;
+                if(previous - now > worst) worst = previous - now;
+            }
+            previous = now;
+            count++;
+        }
+    };
+
+    bool check_virtual()
+    {
+        hw::host::set_clock(hw::host::Clock::Virtual);
+        time::start_timer_daemons<1000>();
+
+        //A period of 2345.678us between two captures
+        time::CaptureStopwatch stopwatch;
+        hw::host::advance_ns(1234567);
+        stopwatch.capture();
+        hw::host::advance_ns(2345678);
+        stopwatch.capture();
+        uint32_t const period = stopwatch.period();
+
+        Reads reads;
+        for(uint32_t i = 0; i < virtual_steps; i++) {
+            hw::host::advance_ns(virtual_step_ns);
+            reads.read();
+        }
+        uint32_t const expected = hw::host::virtual_ns() / 1000;
+        printf("virtual: period %u us (2345 or 2346 expected), %u reads, %u backwards (by up to %u us), %u us at the end, %u expected\n",
+               period, reads.count, reads.backwards, reads.worst, reads.previous, expected);
+        return (period == 2345 || period == 2346) && reads.backwards == 0 && reads.previous == expected;
+    }
+
+    bool check_realtime()
+    {
+        time::start_timer_daemons<1000>();
+        Reads reads;
+        reads.read();
+        time::CaptureStopwatch::us_t const first = reads.previous;
+        auto const begin = std::chrono::steady_clock::now();
+        while(std::chrono::steady_clock::now() - begin < realtime_duration)
+            reads.read();
+        printf("realtime: %u reads, %u backwards (by up to %u us), over %u us\n", reads.count, reads.backwards, reads.worst, reads.previous - first);
+        return reads.backwards == 0 && reads.previous != first;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if(argc != 2) {
+        fputs("usage: check_capture_now virtual|realtime\n", stderr);
+        return 2;
+    }
+    if(strcmp(argv[1], "virtual") == 0)
+        return check_virtual() ? 0 : 1;
+    if(strcmp(argv[1], "realtime") == 0)
+        return check_realtime() ? 0 : 1;
+    fputs("usage: check_capture_now virtual|realtime\n", stderr);
+    return 2;
+}
@@ -0,0 +1,138 @@
+/*
+ * pool_alloc.cpp
+ *
+ * Created: 17/10/2026 11:47:19 AM
+ */
+
+//Checks pool_alloc(), pool_realloc() and pool_free() with LIBMODULE_POOL_BLOCK_SIZES, built with AddressSanitizer where the compiler has it.
+//Sizes from 1 to 40 bytes go to each pool, and past the largest one to malloc(), with pools running out part way through.
+//Every block is filled with its own pattern and checked before it is freed, which finds overlapping blocks inside a pool (that AddressSanitizer can't see).
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <libmodule.h>
+
+#if !defined(LIBMODULE_POOL_BLOCK_SIZES) || !defined(LIBMODULE_HEAP_STATS)
+#error "pool_alloc needs LIBMODULE_POOL_BLOCK_SIZES and LIBMODULE_HEAP_STATS"
+#endif
+
+using namespace libmodule;
+
+namespace
+{
+    constexpr uint16_t rounds = 1000;
+    constexpr uint8_t round_allocations = 20;
+    constexpr size_t max_len = 40;
+    constexpr size_t max_blocks = 64;
+
+    struct Block {
+        uint8_t *ptr;
+        size_t len;
+        uint8_t pattern;
+    };
+
+    Block blocks[max_blocks];
+    size_t block_count = 0;
+    uint32_t corrupted = 0;
+
+    void fill(Block const &block)
+    {
+        memset(block.ptr, block.pattern, block.len);
+    }
+
+    void check(Block const &block)
+    {
+        for(size_t i = 0; i < block.len; i++) {
+            if(block.ptr[i] != block.pattern) {
+                corrupted++;
+                return;
+            }
+        }
+    }
+
+    void free_block(size_t const pos)
+    {
+        check(blocks[pos]);
+        utility::pool_free(blocks[pos].ptr);
+        blocks[pos] = blocks[--block_count];
+    }
+
+    //Polymorphic objects, so that new and delete of a derived class go through the pools
+    struct Base {
+        virtual ~Base() = default;
+        char base[10];
+    };
+    struct Derived : public Base {
+        char derived[20];
+    };
+}
+
+int main()
+{
+    size_t const start_bytes = utility::heap_stats().currentBytes;
+    uint8_t pattern = 0;
+
+    //Allocate a round, free about half of the blocks, and resize a third of the rest. Everything is freed when there are too many blocks.
+    for(uint16_t round = 0; round < rounds; round++) {
+        for(uint8_t i = 0; i < round_allocations && block_count < max_blocks; i++) {
+            Block &block = blocks[block_count++];
+            block.len = 1 + (i * 7 + round) % max_len;
+            block.ptr = static_cast<uint8_t *>(utility::pool_alloc(block.len));
+            block.pattern = ++pattern;
+            fill(block);
+        }
+        for(size_t i = 0; i < block_count; i++)
+            free_block(i);
+        for(size_t i = 0; i < block_count; i += 3) {
+            Block &block = blocks[i];
+            check(block);
+            size_t const len = 1 + (block.len + round) % max_len;
+            block.ptr = static_cast<uint8_t *>(utility::pool_realloc(block.ptr, len));
+            //The contents up to the smaller size are kept
+            block.len = len < block.len ? len : block.len;
+            check(block);
+            block.len = len;
+            fill(block);
+        }
+        if(block_count > 3 * round_allocations) {
+            while(block_count > 0)
+                free_block(block_count - 1);
+        }
+    }
+    while(block_count > 0)
+        free_block(block_count - 1);
+
+    for(uint16_t i = 0; i < rounds; i++) {
+        Base *const derived = new Derived;
+        delete derived;
+        Base *const base = new Base;
+        delete base;
+    }
+
+    //memsizematch() resizes a block through pool_realloc()
+    uint8_t *match = nullptr;
+    size_t match_len = 0;
+    for(uint8_t i = 1; i < 100; i++) {
+        size_t const len = i % 50 + 1;
+        match = utility::memsizematch<size_t>(match, match_len, len);
+        match_len = len;
+        memset(match, 0xAA, len);
+    }
+    utility::pool_free(match);
+
+    //A freed block is the next one handed out of its pool
+    void *const first = utility::pool_alloc(8);
+    void *const second = utility::pool_alloc(8);
+    utility::pool_free(first);
+    void *const reused = utility::pool_alloc(8);
+    utility::pool_free(second);
+    utility::pool_free(reused);
+
+    utility::HeapStats const stats = utility::heap_stats();
+    printf("%u allocations, %u reallocs, %u frees, %u failures, peak %zu bytes, %zu bytes still allocated\n",
+           stats.allocations, stats.reallocs, stats.frees, stats.failures, stats.peakBytes, stats.currentBytes - start_bytes);
+    printf("%u blocks corrupted, freed block reused: %s\n", corrupted, first == reused ? "yes" : "no");
+    return corrupted == 0 && stats.failures == 0 && stats.currentBytes == start_bytes && first == reused ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+/*
+ * prescaler_sleep.cpp
+ *
+ * Created: 17/10/2026 10:58:02 AM
+ */
+
+//Checks that a prescaler with a divider over 32767 counts sleeps correctly. Built with LIBMODULE_TIMER_BASE_FREQUENCY 50000, so the 1Hz prescaler divides by 50000.
+//Each idle() sleeps 40000 base ticks at once, so the remainder the prescaler counts goes over UINT16_MAX.
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <libmodule.h>
+
+using namespace libmodule;
+
+#if LIBMODULE_TIMER_BASE_FREQUENCY != 50000
+#error "prescaler_sleep needs LIBMODULE_TIMER_BASE_FREQUENCY 50000"
+#endif
+
+namespace
+{
+    constexpr uint32_t sleeps = 30;
+    constexpr uint32_t sleep_ticks = 40000;
+}
+
+int main()
+{
+    hw::host::set_clock(hw::host::Clock::Virtual);
+    time::start_timer_daemons<50000, 1>();
+
+    for(uint32_t i = 0; i < sleeps; i++)
+        time::idle(sleep_ticks + 1);
+    uint32_t const base = time::Clock<50000>::now();
+    uint32_t const prescaled = time::Clock<1>::now();
+
+    printf("%u sleeps of %u ticks: %u base ticks, %u 1Hz ticks, %u expected\n", sleeps, sleep_ticks, base, prescaled, base / 50000);
+    return base == sleeps * sleep_ticks && prescaled == base / 50000 ? 0 : 1;
+}
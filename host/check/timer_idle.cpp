@@ -0,0 +1,83 @@
+/*
+ * timer_idle.cpp
+ *
+ * Created: 17/10/2026 10:41:15 AM
+ */
+
+//Checks that sleeping with time::idle() doesn't move any timer deadline.
+//A main loop calls idle() before every tick, on Timer1k, Timer<100> and Timer<10> restarted with random lengths, and checks that each finishes on exactly the tick it was due.
+//Another daemon at 7Hz checks that idle() wakes for ticks that aren't timers.
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <random>
+
+#include <libmodule.h>
+
+using namespace libmodule;
+
+namespace
+{
+    constexpr uint32_t loops = 20000;
+    constexpr size_t other_frequency = 7;
+
+    uint32_t other_ticks = 0;
+    void other_isr()
+    {
+        other_ticks++;
+    }
+
+    struct Checked {
+        uint32_t checks = 0;
+        uint32_t late = 0;
+    };
+
+    //Restarts each timer that has finished, after checking that it finished on its deadline
+    template <size_t tickFrequency_c, size_t count_c>
+    void check_timers(time::Timer<tickFrequency_c> (&timers)[count_c], uint32_t (&deadlines)[count_c], uint16_t const max_ticks, std::mt19937 &random, Checked &checked)
+    {
+        using Clock_t = time::Clock<tickFrequency_c>;
+        for(size_t i = 0; i < count_c; i++) {
+            if(timers[i].running) continue;
+            if(timers[i].finished) {
+                checked.checks++;
+                if(Clock_t::now() != deadlines[i]) checked.late++;
+            }
+            uint16_t const ticks = 1 + random() % max_ticks;
+            timers[i].reset();
+            timers[i] = ticks;
+            timers[i].start();
+            deadlines[i] = Clock_t::now() + ticks;
+        }
+    }
+}
+
+int main()
+{
+    hw::host::set_clock(hw::host::Clock::Virtual);
+    time::start_timer_daemons<1000, 100, 10>();
+    hw::host::start_daemon(other_frequency, &other_isr);
+
+    static Timer1k timers_1k[20];
+    static time::Timer<100> timers_100[10];
+    static time::Timer<10> timers_10[5];
+    uint32_t deadlines_1k[20], deadlines_100[10], deadlines_10[5];
+
+    std::mt19937 random(1);
+    Checked checked;
+    for(uint32_t loop = 0; loop < loops; loop++) {
+        check_timers(timers_1k, deadlines_1k, 3000, random, checked);
+        check_timers(timers_100, deadlines_100, 300, random, checked);
+        check_timers(timers_10, deadlines_10, 30, random, checked);
+        time::idle();
+        hw::host::advance_ticks(1000, 1);
+    }
+    uint32_t const now = time::Clock<1000>::now();
+    //Every tick of the other daemon that was due ran (ticks are at 1/7 s)
+    uint32_t const other_expected = static_cast<uint64_t>(now) * other_frequency / 1000;
+
+    printf("%u loops, %u ticks (%llu slept): %u timers checked, %u not on their deadline\n", loops, now, static_cast<unsigned long long>(hw::host::skipped_ticks()), checked.checks, checked.late);
+    printf("%zuHz daemon: %u ticks, %u expected\n", other_frequency, other_ticks, other_expected);
+    return checked.late == 0 && checked.checks > 0 && other_ticks == other_expected ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/*
+ * timer_model.cpp
+ *
+ * Created: 17/10/2026 10:12:40 AM
+ */
+
+//Checks Timer1k and Stopwatch1k against a model of the per-tick timers they replaced, where the ISR visited every timer on every tick.
+//200000 random operations (set, start, stop, reset, and advancing the virtual clock), comparing every timer's state after each one.
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <random>
+
+#include <libmodule.h>
+
+using namespace libmodule;
+
+namespace
+{
+    constexpr size_t timer_count = 40;
+    constexpr uint32_t operations = 200000;
+    constexpr uint16_t max_ticks = 50;
+    constexpr unsigned max_advance = 4;
+
+    //What Timer and Stopwatch did when the ISR updated each of them every tick
+    struct ModelTimer {
+        uint16_t ticks = 0;
+        bool finished = false;
+        bool running = false;
+
+        void tick() {
+            if(running && --ticks == 0) {
+                running = false;
+                finished = true;
+            }
+        }
+        void start() {
+            if(ticks == 0) {
+                running = false;
+                finished = true;
+                return;
+            }
+            running = true;
+            finished = false;
+        }
+        void reset() {
+            ticks = 0;
+            finished = false;
+            running = false;
+        }
+    };
+
+    struct ModelStopwatch {
+        uint16_t ticks = 0;
+        bool running = false;
+
+        void tick() {
+            if(running) ticks++;
+        }
+    };
+}
+
+int main()
+{
+    hw::host::set_clock(hw::host::Clock::Virtual);
+    time::start_timer_daemons<1000>();
+
+    static Timer1k timers[timer_count];
+    static Stopwatch1k stopwatches[timer_count];
+    ModelTimer model_timers[timer_count];
+    ModelStopwatch model_stopwatches[timer_count];
+
+    std::mt19937 random(1);
+    uint32_t mismatches = 0;
+    for(uint32_t operation = 0; operation < operations; operation++) {
+        size_t const i = random() % timer_count;
+        switch(random() % 8) {
+        case 0: {
+            uint16_t const ticks = random() % max_ticks;
+            //The old timer never stopped if it was set to 0 while running, so that isn't compared
+            if(model_timers[i].running && ticks == 0) break;
+            timers[i] = ticks;
+            model_timers[i].ticks = ticks;
+            break;
+        }
+        case 1:
+            timers[i].start();
+            model_timers[i].start();
+            break;
+        case 2:
+            timers[i].stop();
+            model_timers[i].running = false;
+            break;
+        case 3:
+            timers[i].reset();
+            model_timers[i].reset();
+            break;
+        case 4: {
+            uint16_t const ticks = random() % max_ticks;
+            stopwatches[i] = ticks;
+            model_stopwatches[i].ticks = ticks;
+            break;
+        }
+        case 5:
+            stopwatches[i].start();
+            model_stopwatches[i].running = true;
+            break;
+        case 6:
+            stopwatches[i].stop();
+            model_stopwatches[i].running = false;
+            break;
+        default:
+            for(unsigned ticks = random() % (max_advance + 1); ticks > 0; ticks--) {
+                hw::host::advance_ticks(1000, 1);
+                for(size_t j = 0; j < timer_count; j++) {
+                    model_timers[j].tick();
+                    model_stopwatches[j].tick();
+                }
+            }
+        }
+        for(size_t j = 0; j < timer_count; j++) {
+            if(timers[j].ticks() != model_timers[j].ticks || timers[j].finished != model_timers[j].finished || timers[j].running != model_timers[j].running)
+                mismatches++;
+            if(stopwatches[j].ticks() != model_stopwatches[j].ticks || stopwatches[j].running != model_stopwatches[j].running)
+                mismatches++;
+        }
+    }
+    printf("%u operations on %zu Timer1k and %zu Stopwatch1k: %u mismatches\n", operations, timer_count, timer_count, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
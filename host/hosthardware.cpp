@@ -0,0 +1,270 @@
+/*
+ * hosthardware.cpp
+ *
+ * Created: 16/10/2026 9:33:18 AM
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "hosthardware.h"
+#include <libmodule/utility.h>
+#include <libmodule/timercommon.h>
+
+namespace
+{
+    using libmodule::hw::host::Clock;
+
+    struct Daemon {
+        size_t frequency;
+        void (*isr)();
+        //Virtual time the daemon was started at, and the number of ticks it has run since
+        uint64_t start_ns;
+        uint64_t ticks;
+
+        uint64_t tick_ns(uint64_t const n) const
+        {
+            return start_ns + n * 1000000000 / frequency;
+        }
+    };
+
+    //Recursive, since ATOMIC_BLOCKs can be nested (e.g. Vector::append inside Vector::assign)
+    std::recursive_mutex &interrupt_lock()
+    {
+        static std::recursive_mutex lock;
+        return lock;
+    }
+    //How deeply the current thread is nested in InterruptGuards
+    thread_local unsigned interrupt_depth = 0;
+
+    //Counts of the emulated hardware timer per tick of the base daemon
+    constexpr uint32_t timer_period = libmodule::hw::host::timer_counter_frequency / LIBMODULE_TIMER_BASE_FREQUENCY;
+    static_assert(timer_period > 0 && timer_period <= UINT16_MAX, "LIBMODULE_TIMER_BASE_FREQUENCY can't be emulated with a 16-bit timer counter");
+    //Wall-clock time the last tick was due (Clock::Realtime), or interrupts were last disabled (Clock::Virtual)
+    std::chrono::steady_clock::time_point tick_due;
+
+    Clock clock_source = Clock::Realtime;
+    std::atomic<bool> daemons_running{false};
+    uint64_t clock_virtual_ns = 0;
+    //Wall-clock time spent with interrupts disabled that the virtual clock hasn't caught up with yet
+    uint64_t clock_masked_ns = 0;
+    uint64_t clock_skipped_ticks = 0;
+
+    //Never destroyed, so that daemons can't outlive them during static destruction
+    std::vector<std::thread> &daemon_threads()
+    {
+        static std::vector<std::thread> *threads = new std::vector<std::thread>;
+        return *threads;
+    }
+    std::vector<Daemon> &daemons()
+    {
+        static std::vector<Daemon> *list = new std::vector<Daemon>;
+        return *list;
+    }
+
+    Daemon *base_daemon()
+    {
+        for(auto &daemon : daemons()) {
+            if(daemon.frequency == LIBMODULE_TIMER_BASE_FREQUENCY)
+                return &daemon;
+        }
+        return nullptr;
+    }
+
+    //Counts of the emulated timer counter since the start of the current base tick (without wrapping)
+    uint64_t timer_counts()
+    {
+        uint64_t ns = 0;
+        //In virtual time, the position within the tick is where the virtual clock is.
+        //Time spent with interrupts disabled (including in an isr) is added on from the wall clock, since the virtual clock can't move then.
+        if(clock_source == Clock::Virtual) {
+            Daemon const *const base = base_daemon();
+            if(base != nullptr)
+                ns = clock_virtual_ns - base->tick_ns(base->ticks) + clock_masked_ns;
+        }
+        if(clock_source == Clock::Realtime || interrupt_depth > 0)
+            ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tick_due).count();
+        uint64_t const counts = ns * (libmodule::hw::host::timer_counter_frequency / 1000000) / 1000;
+        //A daemon thread can be more than a tick late, which the hardware never is. The counter stops before it would wrap a second time,
+        //since nothing reading it can tell two wraps from one (and CaptureStopwatch::now() would go back a tick).
+        return counts < 2 * timer_period ? counts : 2 * timer_period - 1;
+    }
+
+    //Moves the virtual clock forwards. The time it moves takes up the time spent with interrupts disabled, so that the counter never goes backwards.
+    void set_virtual_ns(uint64_t const ns)
+    {
+        uint64_t const advanced = ns - clock_virtual_ns;
+        clock_masked_ns -= advanced < clock_masked_ns ? advanced : clock_masked_ns;
+        clock_virtual_ns = ns;
+    }
+
+    void daemon_loop(size_t const frequency, void (*const isr)(), std::chrono::steady_clock::time_point const start)
+    {
+        auto const period = std::chrono::nanoseconds(1000000000 / frequency);
+        auto next = start + period;
+        while(daemons_running) {
+            std::this_thread::sleep_until(next);
+            libmodule::hw::host::InterruptGuard guard;
+            //Only the base daemon's ticks are counted by the timer counter
+            if(frequency == LIBMODULE_TIMER_BASE_FREQUENCY)
+                tick_due = next;
+            next += period;
+            isr();
+        }
+    }
+}
+
+/** Weak, so that a host program can provide its own (e.g. to throw instead of aborting).
+ */
+[[gnu::weak]] void libmodule::hw::panic()
+{
+    fputs("libmodule: hw::panic()\n", stderr);
+    abort();
+}
+
+libmodule::hw::host::InterruptGuard::InterruptGuard()
+{
+    interrupt_lock().lock();
+    //Virtual time stands still while interrupts are disabled, so the time is measured on the wall clock instead (see timer_counts())
+    if(interrupt_depth++ == 0 && clock_source == Clock::Virtual)
+        tick_due = std::chrono::steady_clock::now();
+}
+
+libmodule::hw::host::InterruptGuard::~InterruptGuard()
+{
+    if(--interrupt_depth == 0 && clock_source == Clock::Virtual)
+        clock_masked_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tick_due).count();
+    interrupt_lock().unlock();
+}
+
+void libmodule::hw::host::set_clock(Clock const clock)
+{
+    if(!daemons().empty()) hw::panic();
+    clock_source = clock;
+}
+
+libmodule::hw::host::Clock libmodule::hw::host::get_clock()
+{
+    return clock_source;
+}
+
+void libmodule::hw::host::start_daemon(size_t const frequency, void (*const isr)())
+{
+    if(frequency == 0 || isr == nullptr) hw::panic();
+    //The first daemon registers the exit handler. Registering after the static instance lists are constructed means it runs before they are destroyed.
+    if(!daemons_running.exchange(true))
+        atexit(&stop_daemons);
+    InterruptGuard guard;
+    daemons().push_back({frequency, isr, clock_virtual_ns, 0});
+    if(clock_source == Clock::Realtime) {
+        auto const start = std::chrono::steady_clock::now();
+        //The counter starts from 0 with the base daemon, rather than from the epoch of the wall clock
+        if(frequency == LIBMODULE_TIMER_BASE_FREQUENCY)
+            tick_due = start;
+        daemon_threads().emplace_back(daemon_loop, frequency, isr, start);
+    }
+}
+
+void libmodule::hw::host::stop_daemons()
+{
+    daemons_running = false;
+    for(auto &thread : daemon_threads()) {
+        if(thread.joinable()) thread.join();
+    }
+    daemon_threads().clear();
+    daemons().clear();
+}
+
+uint64_t libmodule::hw::host::virtual_ns()
+{
+    return clock_virtual_ns;
+}
+
+void libmodule::hw::host::advance_ns(uint64_t const ns)
+{
+    if(clock_source != Clock::Virtual || interrupt_depth > 0) hw::panic();
+    uint64_t const target = clock_virtual_ns + ns;
+    auto &list = daemons();
+    while(true) {
+        //Find the daemon with the earliest tick that is due (ties go to the earliest started)
+        Daemon *next = nullptr;
+        for(auto &daemon : list) {
+            if(daemon.tick_ns(daemon.ticks + 1) <= target && (next == nullptr || daemon.tick_ns(daemon.ticks + 1) < next->tick_ns(next->ticks + 1)))
+                next = &daemon;
+        }
+        if(next == nullptr) break;
+        set_virtual_ns(next->tick_ns(++next->ticks));
+        InterruptGuard guard;
+        next->isr();
+    }
+    set_virtual_ns(target);
+}
+
+void libmodule::hw::host::advance_ticks(size_t const frequency, uint64_t const ticks)
+{
+    if(frequency == 0) hw::panic();
+    for(auto const &daemon : daemons()) {
+        if(daemon.frequency == frequency) {
+            advance_ns(daemon.tick_ns(daemon.ticks + ticks) - clock_virtual_ns);
+            return;
+        }
+    }
+    advance_ns(ticks * 1000000000 / frequency);
+}
+
+/** In real time, the counter is derived from the wall-clock time since the tick was due.
+ * In virtual time, it is the position of the virtual clock within the tick, plus the wall-clock time spent with interrupts disabled that the virtual clock hasn't moved past yet
+ * (so ISR and critical section durations are still measured, and the counter doesn't go backwards).
+ */
+uint16_t libmodule::hw::timer_counter()
+{
+    return timer_counts() % timer_period;
+}
+
+uint16_t libmodule::hw::timer_counter_period()
+{
+    return timer_period;
+}
+
+bool libmodule::hw::timer_tick_pending()
+{
+    //In virtual time the next tick runs as soon as it is due, so this can only be an isr overrunning on the wall clock
+    return timer_counts() >= timer_period;
+}
+
+/** Only sleeps with Clock::Virtual, by moving the virtual clock and the base daemon past the ticks slept without running them.
+ * A tick of any other daemon is an interrupt, so it wakes the sleep before it. With Clock::Realtime it returns 0.
+ */
+uint32_t libmodule::hw::timer_sleep(uint32_t const ticks)
+{
+    if(clock_source != Clock::Virtual) return 0;
+    auto &list = daemons();
+    Daemon *const base = base_daemon();
+    if(base == nullptr) return 0;
+    uint64_t slept = ticks;
+    for(auto const &daemon : list) {
+        if(&daemon == base) continue;
+        //Base ticks that happen before the other daemon's next tick
+        uint64_t const wake = daemon.tick_ns(daemon.ticks + 1);
+        while(slept > 0 && base->tick_ns(base->ticks + slept) >= wake) {
+            //Jump close with a division, then step the rest of the way
+            uint64_t const estimate = (wake - base->start_ns) / 1000000000 * base->frequency + (wake - base->start_ns) % 1000000000 * base->frequency / 1000000000;
+            slept = estimate > base->ticks && estimate - base->ticks < slept ? estimate - base->ticks : slept - 1;
+        }
+    }
+    base->ticks += slept;
+    if(slept > 0) set_virtual_ns(base->tick_ns(base->ticks));
+    clock_skipped_ticks += slept;
+    return slept;
+}
+
+uint64_t libmodule::hw::host::skipped_ticks()
+{
+    return clock_skipped_ticks;
+}
@@ -0,0 +1,67 @@
+/*
+ * hosthardware.h
+ *
+ * Created: 16/10/2026 9:15:02 AM
+ */
+
+//Simulated hardware layer used when building libmodule for a Linux host.
+//It provides what a hardware repository (e.g. SEMlibmicavr) would provide: hw::panic(), the hw::timer_counter() hooks, TimerBase (see timerhardware.h) and the timer daemons.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace libmodule
+{
+    namespace hw
+    {
+        namespace host
+        {
+            //Emulates disabling the global interrupt flag for its lifetime.
+            //Timer daemons hold the same lock while running an "interrupt", so an ISR never runs inside an ATOMIC_BLOCK.
+            //Can be nested.
+            class InterruptGuard
+            {
+            public:
+                InterruptGuard();
+                ~InterruptGuard();
+                InterruptGuard(InterruptGuard const &) = delete;
+                InterruptGuard &operator=(InterruptGuard const &) = delete;
+            };
+
+            enum class Clock {
+                //Each daemon is a thread that interrupts frequency times per second (wall-clock)
+                Realtime,
+                //Daemons only run when the virtual clock is advanced, from the thread advancing it
+                Virtual,
+            };
+            //Selects the clock that drives the daemons. Must be called before any daemon is started. Defaults to Clock::Realtime.
+            void set_clock(Clock const clock);
+            Clock get_clock();
+
+            //Frequency of the emulated hardware timer counter (see hw::timer_counter()), as an AVR timer with no prescaler at 16MHz
+            constexpr uint32_t timer_counter_frequency = 16000000;
+
+            //Starts a daemon that calls isr() with interrupts disabled, frequency times per second.
+            void start_daemon(size_t const frequency, void (*const isr)());
+            //Stops all daemons (joining their threads if Clock::Realtime). Called automatically on exit.
+            void stop_daemons();
+
+            //---Virtual clock---
+            //Tick n of a daemon started at virtual time s happens at s + n * 1e9 / frequency (ns), so there is no drift.
+            //Daemons due at the same time run in the order they were started.
+            //These may not be called from inside an ATOMIC_BLOCK (an interrupt could never be taken there).
+
+            //Nanoseconds elapsed on the virtual clock
+            uint64_t virtual_ns();
+            //Advances the virtual clock by ns, running every daemon tick that becomes due
+            void advance_ns(uint64_t const ns);
+            //Advances the virtual clock to the time of the ticks'th next tick of the daemon with the given frequency.
+            //If that daemon hasn't been started, advances by ticks periods of frequency.
+            void advance_ticks(size_t const frequency, uint64_t const ticks);
+            //Ticks of the base daemon that were slept through by time::idle() instead of being run
+            uint64_t skipped_ticks();
+        }
+    }
+}
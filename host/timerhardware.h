@@ -0,0 +1,47 @@
+/*
+ * timerhardware.h
+ *
+ * Created: 16/10/2026 9:21:40 AM
+ */
+
+//Host implementation of TimerBase.
+//Like the microcontroller implementations, the host provides a daemon for one frequency (LIBMODULE_TIMER_BASE_FREQUENCY),
+//and every other TickFrequency is divided down from it (see timercommon.h).
+//Whether the daemon runs in wall-clock or virtual time is chosen with hw::host::set_clock().
+
+#pragma once
+
+#include <libmodule/utility.h>
+#include <libmodule/timercommon.h>
+#include <hosthardware.h>
+
+namespace libmodule
+{
+    namespace time
+    {
+        template <>
+        class TimerBase<LIBMODULE_TIMER_BASE_FREQUENCY> : public TimerQueue<LIBMODULE_TIMER_BASE_FREQUENCY>
+        {
+            template <size_t ...>
+            friend void start_timer_daemons();
+        public:
+            //Advances the timer queue of the base frequency (and the frequencies divided from it) by one tick (what the timer interrupt would do)
+            static void handle_isr();
+        private:
+            static void start_daemon();
+        };
+    }
+}
+
+inline void libmodule::time::TimerBase<LIBMODULE_TIMER_BASE_FREQUENCY>::handle_isr()
+{
+    TimerBase::tq_handle_tick();
+}
+
+inline void libmodule::time::TimerBase<LIBMODULE_TIMER_BASE_FREQUENCY>::start_daemon()
+{
+    static bool started = false;
+    if(started) return;
+    started = true;
+    hw::host::start_daemon(LIBMODULE_TIMER_BASE_FREQUENCY, &handle_isr);
+}
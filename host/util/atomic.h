@@ -0,0 +1,20 @@
+/*
+ * atomic.h
+ *
+ * Created: 16/10/2026 9:08:45 AM
+ */
+
+//Host stand-in for <util/atomic.h>.
+//The global interrupt flag is emulated by hw::host::InterruptGuard, which is also held by the timer daemons while they "interrupt".
+//Like the avr-libc version, leaving the block by any means (including return/break) restores the previous state.
+
+#pragma once
+
+#include <hosthardware.h>
+
+//The state argument is accepted for compatibility. The host always restores the previous state.
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+
+#define ATOMIC_BLOCK(type) for(::libmodule::hw::host::InterruptGuard lm_atomic_guard_, *lm_atomic_once_ = &lm_atomic_guard_; \
+                               lm_atomic_once_ != nullptr; lm_atomic_once_ = nullptr)
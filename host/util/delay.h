@@ -0,0 +1,14 @@
+/*
+ * delay.h
+ *
+ * Created: 16/10/2026 9:06:20 AM
+ */
+
+//Host stand-in for <util/delay.h>.
+//The delays in libmodule only exist to meet the setup/hold times of real ICs (e.g. the 74HC595).
+//There is nothing to wait for on the host, and waiting would only distort profiles, so they do nothing.
+
+#pragma once
+
+inline void _delay_us(double const) {}
+inline void _delay_ms(double const) {}
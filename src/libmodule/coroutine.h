@@ -0,0 +1,96 @@
+/*
+ * coroutine.h
+ *
+ * Created: 16/10/2026 3:40:12 PM
+ */
+
+//Stackless coroutines (protothreads), for writing update() state machines as straight line code.
+//The function body is wrapped in a switch on the line number it last stopped at (Duff's device), so the state is
+//only the resume line and a DeadlineTimer, and no stack is kept between calls.
+//
+//Example, blinking an LED twice then waiting for a second:
+//    void Thing::update()
+//    {
+//        LM_CO_BEGIN(pm_co);
+//        for(pm_count = 0; pm_count < 2; pm_count++) {
+//            led.set(true);
+//            LM_CO_AWAIT_TICKS(pm_co, 125);
+//            led.set(false);
+//            LM_CO_AWAIT_TICKS(pm_co, 250);
+//        }
+//        LM_CO_AWAIT_TICKS(pm_co, 1000);
+//        LM_CO_END(pm_co);
+//    }
+//
+//Restrictions (the same as for any protothread):
+// - Local variables are not kept between calls. Keep state in members.
+// - A switch statement may not be used between LM_CO_BEGIN and LM_CO_END, and only one LM_CO_ macro may be used per line.
+// - The function must return void.
+
+#pragma once
+
+#include <stdlib.h>
+
+#include "utility.h"
+#include "timer.h"
+
+namespace libmodule
+{
+    namespace time
+    {
+        //State of a coroutine. Waits are measured with a DeadlineTimer, so a waiting coroutine costs the timer ISR nothing.
+        template <size_t tickFrequency_c = 1000>
+        struct Coroutine {
+            using Clock_t = Clock<tickFrequency_c>;
+            using tick_t = typename Clock_t::tick_t;
+
+            //Returns whether the coroutine is waiting on LM_CO_AWAIT_TICKS. Calling it while waiting only returns straight away.
+            bool co_waiting() const;
+            //Returns the ticks until the wait finishes (0 if not waiting). Can be given to time::idle().
+            tick_t co_ticks_until_ready() const;
+            //Starts the coroutine from LM_CO_BEGIN on the next call
+            void co_reset();
+
+            //Line to resume from (0 is the start)
+            uint16_t co_line = 0;
+            bool co_wait = false;
+            DeadlineTimer<tickFrequency_c> co_timer;
+        };
+
+    } //time
+
+//Type aliases
+    using Coroutine1k = time::Coroutine<1000>;
+
+} //libmodule
+
+//Starts the coroutine body. co is a Coroutine.
+#define LM_CO_BEGIN(co) switch((co).co_line) { case 0:
+//Returns, and continues from here on the next call
+#define LM_CO_YIELD(co) do { (co).co_line = __LINE__; return; case __LINE__:; } while(0)
+//Returns until cond is true (cond is checked on every call, including this one)
+#define LM_CO_AWAIT(co, cond) do { (co).co_line = __LINE__; case __LINE__: if(!(cond)) return; } while(0)
+//Returns until ticks ticks have passed
+#define LM_CO_AWAIT_TICKS(co, ticks) do { (co).co_timer.start(ticks); (co).co_wait = true; (co).co_line = __LINE__; case __LINE__: \
+                                          if((co).co_timer) (co).co_wait = false; else return; } while(0)
+//Ends the coroutine body. The next call starts from LM_CO_BEGIN again.
+#define LM_CO_END(co) } (co).co_line = 0
+
+template <size_t tickFrequency_c /*= 1000*/>
+bool libmodule::time::Coroutine<tickFrequency_c>::co_waiting() const
+{
+    return co_wait && !co_timer;
+}
+
+template <size_t tickFrequency_c /*= 1000*/>
+typename libmodule::time::Coroutine<tickFrequency_c>::tick_t libmodule::time::Coroutine<tickFrequency_c>::co_ticks_until_ready() const
+{
+    return co_wait ? co_timer.remaining() : 0;
+}
+
+template <size_t tickFrequency_c /*= 1000*/>
+void libmodule::time::Coroutine<tickFrequency_c>::co_reset()
+{
+    co_line = 0;
+    co_wait = false;
+}
@@ -48,7 +48,7 @@ void libmodule::userio::IC_LTD_2601G_11::write_characters(char const str[], uint
 
     //Invert digits, since the display uses a common anode (therefore 1 is off)
     //Atomically copy localdigitdata into digitdata
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    LM_ATOMIC_BLOCK() {
         digitdata[0] = ~localdigitdata[0];
         digitdata[1] = ~localdigitdata[1];
     }
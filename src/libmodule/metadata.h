@@ -30,6 +30,17 @@ namespace libmodule
     {
         namespace metadata
         {
+            //Describes a register: a value of type T at offset_c in a module's buffer.
+            //Used with Buffer::get/set/get_snapshot, and the StaticBuffer overloads of them which check at compile time that the register fits in the buffer.
+            //Each layout has a namespace field with a Field for each register (Horn only uses the com layout).
+            template <typename T, size_t offset_c>
+            struct Field {
+                using type = T;
+                static constexpr size_t offset = offset_c;
+                //Offset past the last byte
+                static constexpr size_t end = offset_c + sizeof(T);
+            };
+
             namespace com
             {
                 constexpr size_t NameLength = 8;
@@ -46,6 +57,13 @@ namespace libmodule
                         _size,
                     };
                 }
+                namespace field
+                {
+                    using Signature = Field<uint8_t, offset::Signature>;
+                    using ID = Field<uint8_t, offset::ID>;
+                    using Status = Field<uint8_t, offset::Status>;
+                    using Settings = Field<uint8_t, offset::Settings>;
+                }
                 namespace sig
                 {
                     namespace status
@@ -100,6 +118,21 @@ namespace libmodule
                         };
                     }
                 }
+                namespace field
+                {
+                    namespace manager
+                    {
+                        using InstanceCount = Field<uint8_t, offset::manager::InstanceCount>;
+                        using SampleCount = Field<uint8_t, offset::manager::SampleCount>;
+                    }
+                    //Relative to the instance's region of the buffer
+                    namespace instance
+                    {
+                        using Constant_RPS = Field<rps_t, offset::instance::Constant_RPS>;
+                        using Constant_TPS = Field<cps_t, offset::instance::Constant_TPS>;
+                        using SamplePos = Field<uint8_t, offset::instance::SamplePos>;
+                    }
+                }
                 namespace sig
                 {
                     namespace status
@@ -130,10 +163,20 @@ namespace libmodule
                         MeasuredVoltage = MeasuredCurrent + sizeof(uint16_t),
                         PWMFrequency = MeasuredVoltage + sizeof(uint16_t),
                         PWMDutyCycle = PWMFrequency + sizeof(uint16_t),
-                        ControlVoltage,
-                        _size,
+                        ControlVoltage = PWMDutyCycle + sizeof(uint8_t),
+                        _size = ControlVoltage + sizeof(uint16_t),
                     };
                 }
+                namespace field
+                {
+                    using Voltage_MaxCurrent = Field<uint16_t, offset::Voltage_MaxCurrent>;
+                    using PWM_MaxCurrent = Field<uint16_t, offset::PWM_MaxCurrent>;
+                    using MeasuredCurrent = Field<uint16_t, offset::MeasuredCurrent>;
+                    using MeasuredVoltage = Field<uint16_t, offset::MeasuredVoltage>;
+                    using PWMFrequency = Field<uint16_t, offset::PWMFrequency>;
+                    using PWMDutyCycle = Field<uint8_t, offset::PWMDutyCycle>;
+                    using ControlVoltage = Field<uint16_t, offset::ControlVoltage>;
+                }
                 namespace sig
                 {
                     namespace status
@@ -174,9 +217,15 @@ namespace libmodule
                         Position_Engaged = com::offset::_size,
                         Position_Disengaged = Position_Engaged + sizeof(uint16_t),
                         ContinuousPosition = Position_Disengaged + sizeof(uint16_t),
-                        _size,
+                        _size = ContinuousPosition + sizeof(uint16_t),
                     };
                 }
+                namespace field
+                {
+                    using Position_Engaged = Field<uint16_t, offset::Position_Engaged>;
+                    using Position_Disengaged = Field<uint16_t, offset::Position_Disengaged>;
+                    using ContinuousPosition = Field<uint16_t, offset::ContinuousPosition>;
+                }
                 namespace sig
                 {
                     namespace settings
@@ -195,6 +244,42 @@ namespace libmodule
                     }
                 }
             }
+            //Layout written by module::write_timer_stats(), relative to the position given to it.
+            //Durations and latencies are in counts of the hardware timer, CounterPeriod counts per tick.
+            namespace timerstats
+            {
+                namespace offset
+                {
+                    enum e {
+                        Ticks = 0,
+                        Expired = Ticks + sizeof(uint32_t),
+                        MissedTicks = Expired + sizeof(uint32_t),
+                        WorstDuration = MissedTicks + sizeof(uint16_t),
+                        AverageDuration = WorstDuration + sizeof(uint16_t),
+                        Jitter = AverageDuration + sizeof(uint16_t),
+                        CounterPeriod = Jitter + sizeof(uint16_t),
+                        _size = CounterPeriod + sizeof(uint16_t),
+                    };
+                }
+            }
+            //Layout written by module::write_heap_stats(), relative to the position given to it.
+            //Byte counts are saturated to 16 bits.
+            namespace heapstats
+            {
+                namespace offset
+                {
+                    enum e {
+                        CurrentBytes = 0,
+                        PeakBytes = CurrentBytes + sizeof(uint16_t),
+                        LargestFree = PeakBytes + sizeof(uint16_t),
+                        Allocations = LargestFree + sizeof(uint16_t),
+                        Frees = Allocations + sizeof(uint32_t),
+                        Reallocs = Frees + sizeof(uint32_t),
+                        Failures = Reallocs + sizeof(uint32_t),
+                        _size = Failures + sizeof(uint16_t),
+                    };
+                }
+            }
         }
     }
 }
@@ -26,12 +26,12 @@ bool libmodule::module::Slave::connected() const
 
 void libmodule::module::Slave::set_signature(uint8_t const signature)
 {
-    buffer.serialiseWrite(signature, metadata::com::offset::Signature);
+    buffer.set<metadata::com::field::Signature>(signature);
 }
 
 void libmodule::module::Slave::set_id(uint8_t const id)
 {
-    buffer.serialiseWrite(id, metadata::com::offset::ID);
+    buffer.set<metadata::com::field::ID>(id);
 }
 
 void libmodule::module::Slave::set_name(char const name[])
@@ -69,6 +69,7 @@ void libmodule::module::Slave::update()
     //Note: Status is special
     if(previousconnected != buffermanager.connected()) {
         previousconnected = buffermanager.connected();
+        utility::Buffer::Transaction transaction(buffer);
         //Header
         buffer.write(static_cast<void const *>(metadata::com::Header), sizeof(metadata::com::Header), 0);
         //Active (should always read as 1)
@@ -268,8 +269,8 @@ void libmodule::module::MotorController::update()
     bool reset_timeout = false;
 
     //Read max current from buffer
-    uint16_t const max_current = buffer.serialiseRead<uint16_t>(
-                                     pm_motormode == MotorMode::Voltage ? metadata::motorcontroller::offset::Voltage_MaxCurrent : metadata::motorcontroller::offset::PWM_MaxCurrent);
+    uint16_t const max_current = pm_motormode == MotorMode::Voltage ? buffer.get_snapshot<metadata::motorcontroller::field::Voltage_MaxCurrent>()
+                                 : buffer.get_snapshot<metadata::motorcontroller::field::PWM_MaxCurrent>();
 
     //If over-current condition occurred
     if(connected() && pm_measured_mA > max_current && pm_timer && pm_overcurrentstate != OvercurrentState::Off) {
@@ -308,24 +309,24 @@ void libmodule::module::MotorController::update()
     if(pm_overcurrentstate == OvercurrentState::None) {
         set_operational(true);
         pm_motormode = static_cast<MotorMode>(
-                           (buffer.serialiseRead<uint8_t>(metadata::com::offset::Settings) & metadata::motorcontroller::mask::settings::MotorMode)
+                           (buffer.get<metadata::com::field::Settings>() & metadata::motorcontroller::mask::settings::MotorMode)
                            >> metadata::motorcontroller::sig::settings::MotorMode);
     }
     if(previousovercurrent != pm_overcurrentstate) {
-        buffer.bit_clear_mask(metadata::com::offset::Status, metadata::motorcontroller::mask::status::OvercurrentState);
-        buffer.bit_set_mask(metadata::com::offset::Status, static_cast<uint8_t>(pm_overcurrentstate) << metadata::motorcontroller::sig::status::OvercurrentState);
+        buffer.bit_update(metadata::com::offset::Status, metadata::motorcontroller::mask::status::OvercurrentState,
+                          static_cast<uint8_t>(pm_overcurrentstate) << metadata::motorcontroller::sig::status::OvercurrentState);
     }
 }
 
 void libmodule::module::MotorController::set_measured_current(uint16_t const mA)
 {
     pm_measured_mA = mA;
-    buffer.serialiseWrite(mA, metadata::motorcontroller::offset::MeasuredCurrent);
+    buffer.set<metadata::motorcontroller::field::MeasuredCurrent>(mA);
 }
 
 void libmodule::module::MotorController::set_measured_voltage(uint16_t const mV)
 {
-    buffer.serialiseWrite(mV, metadata::motorcontroller::offset::MeasuredVoltage);
+    buffer.set<metadata::motorcontroller::field::MeasuredVoltage>(mV);
 }
 
 void libmodule::module::MotorController::set_overcurrent_timeout(uint16_t const ms)
@@ -340,17 +341,17 @@ libmodule::module::MotorController::MotorMode libmodule::module::MotorController
 
 uint16_t libmodule::module::MotorController::get_pwm_frequency() const
 {
-    return buffer.serialiseRead<uint16_t>(metadata::motorcontroller::offset::PWMFrequency);
+    return buffer.get_snapshot<metadata::motorcontroller::field::PWMFrequency>();
 }
 
 uint8_t libmodule::module::MotorController::get_pwm_duty() const
 {
-    return buffer.serialiseRead<uint8_t>(metadata::motorcontroller::offset::PWMDutyCycle);
+    return buffer.get<metadata::motorcontroller::field::PWMDutyCycle>();
 }
 
 uint16_t libmodule::module::MotorController::get_control_mV() const
 {
-    return buffer.serialiseRead<uint16_t>(metadata::motorcontroller::offset::ControlVoltage);
+    return buffer.get_snapshot<metadata::motorcontroller::field::ControlVoltage>();
 }
 
 libmodule::module::MotorController::MotorController(twi::TWISlave &twislave) : Slave(twislave, buffer)
@@ -362,12 +363,12 @@ libmodule::module::MotorController::MotorController(twi::TWISlave &twislave) : S
 
 void libmodule::module::MotorMover::set_position_engaged(uint16_t const pos)
 {
-    buffer.serialiseWrite(pos, metadata::motormover::offset::Position_Engaged);
+    buffer.set<metadata::motormover::field::Position_Engaged>(pos);
 }
 
 void libmodule::module::MotorMover::set_position_disengaged(uint16_t const pos)
 {
-    buffer.serialiseWrite(pos, metadata::motormover::offset::Position_Disengaged);
+    buffer.set<metadata::motormover::field::Position_Disengaged>(pos);
 }
 
 void libmodule::module::MotorMover::set_engaged(bool const engaged)
@@ -387,7 +388,7 @@ bool libmodule::module::MotorMover::get_binary_engaged() const
 
 uint16_t libmodule::module::MotorMover::get_continuous_position() const
 {
-    return buffer.serialiseRead<uint16_t>(metadata::motormover::offset::ContinuousPosition);
+    return buffer.get_snapshot<metadata::motormover::field::ContinuousPosition>();
 }
 
 bool libmodule::module::MotorMover::get_mechanism_powered() const
@@ -401,3 +402,19 @@ libmodule::module::MotorMover::MotorMover(twi::TWISlave &twislave) : Slave(twisl
     buffer.bit_set(metadata::com::offset::Status, metadata::com::sig::status::Active, true);
     set_operational(true);
 }
+
+#ifdef LIBMODULE_HEAP_STATS
+void libmodule::module::write_heap_stats(utility::Buffer &buffer, size_t const pos)
+{
+    namespace offset = metadata::heapstats::offset;
+    utility::HeapStats const stats = utility::heap_stats();
+    auto const saturate = [](size_t const bytes) -> uint16_t { return bytes > UINT16_MAX ? UINT16_MAX : bytes; };
+    buffer.serialiseWrite(saturate(stats.currentBytes), pos + offset::CurrentBytes);
+    buffer.serialiseWrite(saturate(stats.peakBytes), pos + offset::PeakBytes);
+    buffer.serialiseWrite(saturate(stats.largestFree), pos + offset::LargestFree);
+    buffer.serialiseWrite(stats.allocations, pos + offset::Allocations);
+    buffer.serialiseWrite(stats.frees, pos + offset::Frees);
+    buffer.serialiseWrite(stats.reallocs, pos + offset::Reallocs);
+    buffer.serialiseWrite(stats.failures, pos + offset::Failures);
+}
+#endif
@@ -11,6 +11,7 @@
 #include "utility.h"
 #include "userio.h"
 #include "twislave.h"
+#include "timer.h"
 
 namespace libmodule
 {
@@ -71,6 +72,9 @@ namespace libmodule
             void set_tps_constant(metadata::speedmonitor::cps_t const tps);
 
             void push_sample(sample_t const sample);
+            //Pushes the samples waiting in queue (e.g. periods captured in an ISR), so that the master sees them together
+            template <uint8_t queue_len_c>
+            void push_samples(utility::SpscQueue<sample_t, queue_len_c> &queue);
             sample_t get_sample(uint8_t const pos);
             void clear_samples();
         private:
@@ -174,6 +178,17 @@ namespace libmodule
             utility::StaticBuffer<metadata::motormover::offset::_size> buffer;
         };
 
+#ifdef LIBMODULE_TIMER_STATS
+        //Writes the TimerStats of the daemon of tickFrequency_c to buffer at pos (see metadata::timerstats for the layout).
+        //Call it periodically with a region of a Slave's buffer to make the statistics readable by the master.
+        template <size_t tickFrequency_c>
+        void write_timer_stats(utility::Buffer &buffer, size_t const pos);
+#endif
+#ifdef LIBMODULE_HEAP_STATS
+        //Writes utility::heap_stats() to buffer at pos (see metadata::heapstats for the layout).
+        void write_heap_stats(utility::Buffer &buffer, size_t const pos);
+#endif
+
         //Handles the common client/module code that is not communication (modes, leds, buttons)
         class Client
         {
@@ -225,7 +240,7 @@ namespace libmodule
 template <size_t len_c, typename sample_t /*= uint32_t*/>
 void libmodule::module::SpeedMonitor<len_c, sample_t>::set_rps_constant(metadata::speedmonitor::rps_t const rps)
 {
-    buffer.serialiseWrite(rps, metadata::speedmonitor::offset::instance::Constant_RPS);
+    buffer.set<metadata::speedmonitor::field::instance::Constant_RPS>(rps);
     pm_rps = rps;
 }
 
@@ -233,7 +248,7 @@ void libmodule::module::SpeedMonitor<len_c, sample_t>::set_rps_constant(metadata
 template <size_t len_c, typename sample_t /*= uint32_t*/>
 void libmodule::module::SpeedMonitor<len_c, sample_t>::set_tps_constant(metadata::speedmonitor::rps_t const tps)
 {
-    buffer.serialiseWrite(tps, metadata::speedmonitor::offset::instance::Constant_TPS);
+    buffer.set<metadata::speedmonitor::field::instance::Constant_TPS>(tps);
     pm_tps = tps;
 }
 
@@ -241,14 +256,27 @@ void libmodule::module::SpeedMonitor<len_c, sample_t>::set_tps_constant(metadata
 template <size_t len_c, typename sample_t /*= uint32_t*/>
 void libmodule::module::SpeedMonitor<len_c, sample_t>::push_sample(sample_t const sample)
 {
+    //The sample and SamplePos are written together, so that the master doesn't read one without the other
+    utility::Buffer::Transaction transaction(buffer);
+    //Checked, so that a monitor that hasn't been registered with a manager (no buffer yet) panics instead of writing through nullptr
     buffer.serialiseWrite(sample, metadata::speedmonitor::offset::instance::SampleBuffer + pm_samplepos * sizeof(sample_t));
-    buffer.serialiseWrite(pm_samplepos, metadata::speedmonitor::offset::instance::SamplePos);
+    buffer.set<metadata::speedmonitor::field::instance::SamplePos>(pm_samplepos);
     if(++pm_samplepos >= len_c) {
         pm_samplepos = 0;
     }
 }
 
 
+template <size_t len_c, typename sample_t /*= uint32_t*/>
+template <uint8_t queue_len_c>
+void libmodule::module::SpeedMonitor<len_c, sample_t>::push_samples(utility::SpscQueue<sample_t, queue_len_c> &queue)
+{
+    utility::Buffer::Transaction transaction(buffer);
+    sample_t sample;
+    while(queue.pop(sample))
+        push_sample(sample);
+}
+
 template <size_t len_c, typename sample_t /*= uint32_t*/>
 sample_t libmodule::module::SpeedMonitor<len_c, sample_t>::get_sample(uint8_t const pos)
 {
@@ -260,7 +288,11 @@ sample_t libmodule::module::SpeedMonitor<len_c, sample_t>::get_sample(uint8_t co
 template <size_t len_c, typename sample_t /*= uint32_t*/>
 void libmodule::module::SpeedMonitor<len_c, sample_t>::clear_samples()
 {
+    if(buffer.pm_len < metadata::speedmonitor::offset::instance::SampleBuffer + len_c * sizeof(sample_t))
+        hw::panic();
+    utility::Buffer::Transaction transaction(buffer);
     memset(buffer.pm_ptr + metadata::speedmonitor::offset::instance::SampleBuffer, 0, len_c * sizeof(sample_t));
+    buffer.mark_dirty(metadata::speedmonitor::offset::instance::SampleBuffer, len_c * sizeof(sample_t));
     pm_samplepos = 0;
 }
 
@@ -280,6 +312,9 @@ void libmodule::module::SpeedMonitorManager<SpeedMonitor_t, count_c>::register_s
 
     instance->buffer.pm_ptr = buffer.pm_ptr + manager_buffer_size_c + pos * instance_buffer_size_c;
     instance->buffer.pm_len = instance_buffer_size_c;
+    //Writes to the instance are writes to this buffer
+    instance->buffer.m_parent = &buffer;
+    instance->buffer.mark_dirty(0, instance_buffer_size_c);
     pm_monitors[pos] = instance;
 }
 
@@ -297,11 +332,27 @@ void libmodule::module::SpeedMonitorManager<SpeedMonitor_t, count_c>::write_cons
 {
     //Set sample size, instance count, and sample count
     buffer.bit_set_mask(metadata::com::offset::Status, sizeof(sample_t) << metadata::speedmonitor::sig::status::SampleSize);
-    buffer.serialiseWrite(static_cast<uint8_t>(count_c), metadata::speedmonitor::offset::manager::InstanceCount);
-    buffer.serialiseWrite(static_cast<uint8_t>(len_c), metadata::speedmonitor::offset::manager::SampleCount);
+    buffer.template set<metadata::speedmonitor::field::manager::InstanceCount>(static_cast<uint8_t>(count_c));
+    buffer.template set<metadata::speedmonitor::field::manager::SampleCount>(static_cast<uint8_t>(len_c));
     //Write constants for attached SpeedMonitors
     for(uint8_t i = 0; i < count_c; i++) {
         if(pm_monitors[i] != nullptr)
             pm_monitors[i]->write_constants();
     }
 }
+
+#ifdef LIBMODULE_TIMER_STATS
+template <size_t tickFrequency_c>
+void libmodule::module::write_timer_stats(utility::Buffer &buffer, size_t const pos)
+{
+    namespace offset = metadata::timerstats::offset;
+    time::TimerStats const stats = time::TimerBase<tickFrequency_c>::tq_stats();
+    buffer.serialiseWrite(stats.ticks, pos + offset::Ticks);
+    buffer.serialiseWrite(stats.expired, pos + offset::Expired);
+    buffer.serialiseWrite(stats.missedTicks, pos + offset::MissedTicks);
+    buffer.serialiseWrite(stats.worstDuration, pos + offset::WorstDuration);
+    buffer.serialiseWrite(stats.averageDuration(), pos + offset::AverageDuration);
+    buffer.serialiseWrite(stats.jitter(), pos + offset::Jitter);
+    buffer.serialiseWrite(hw::timer_counter_period(), pos + offset::CounterPeriod);
+}
+#endif
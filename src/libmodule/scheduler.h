@@ -0,0 +1,198 @@
+/*
+ * scheduler.h
+ *
+ * Created: 16/10/2026 2:12:37 PM
+ */
+
+#pragma once
+
+#include <stdlib.h>
+
+#include "utility.h"
+#include "timer.h"
+
+namespace libmodule
+{
+    namespace time
+    {
+        //Cooperative scheduler for update() style functions.
+        //Instead of calling every update() from the main loop as fast as possible, each one is registered as a Task with a period,
+        //and Scheduler::update() (called from the main loop) only runs the tasks that are due.
+        //Tasks run to completion, in order of priority (highest first) when several are due.
+        //If LIBMODULE_SCHEDULER_STATS is defined, the time each task takes is measured with CaptureStopwatch (so the hw::timer_counter() hooks are needed).
+        template <size_t tickFrequency_c = 1000>
+        class Scheduler
+        {
+        public:
+            using Clock_t = Clock<tickFrequency_c>;
+            using tick_t = typename Clock_t::tick_t;
+
+            struct Task {
+                friend Scheduler;
+                //Called when the task is due
+                virtual void task_run() = 0;
+
+                //Ticks between runs. 0 runs the task on every Scheduler::update().
+                uint16_t period;
+                //Higher priority tasks are run first
+                uint8_t priority;
+
+                //Times the task ran a whole period (or more) late. Missed runs are skipped, not caught up on.
+                uint16_t overruns = 0;
+#ifdef LIBMODULE_SCHEDULER_STATS
+                //Longest time task_run() has taken, in microseconds (see CaptureStopwatch)
+                CaptureStopwatch::us_t worstMicros = 0;
+#endif
+
+                Task(uint16_t const period, uint8_t const priority = 0);
+                //Tasks are linked into the scheduler's list, so they can't be copied
+                Task(Task const &) = delete;
+                Task &operator=(Task const &) = delete;
+                //Removes the task from its scheduler. Must not be called from task_run().
+                virtual ~Task();
+            private:
+                //Clock tick the task is next due at
+                tick_t pm_due = 0;
+                Task *pm_next = nullptr;
+                //Scheduler the task has been added to (nullptr if none)
+                Scheduler *pm_scheduler = nullptr;
+            };
+
+            //Can be used to call a member function of an object of type T (e.g. &Client::update) as a task.
+            template <typename T>
+            struct Task_MemFnCallback : public Task {
+                void task_run() override;
+
+                using callback_t = void (T::*)();
+
+                T *callback_ptr;
+                callback_t callback;
+                Task_MemFnCallback(T *const callback_ptr, callback_t const callback, uint16_t const period, uint8_t const priority = 0);
+            };
+
+            //Runs the tasks that are due
+            void update();
+
+            //Adds a task. It is first due on the next update(). If it was added to another scheduler, it is removed from that one.
+            //Must not be called from task_run().
+            void add(Task *const task);
+            //Removes a task, if it has been added. Must not be called from task_run().
+            void remove(Task *const task);
+
+            //Returns the ticks until the next task is due (0 if a task is due now), or UINT32_MAX if there are no tasks.
+            tick_t ticks_until_due() const;
+
+            Scheduler() = default;
+            //Tasks point back to their scheduler, so it can't be copied
+            Scheduler(Scheduler const &) = delete;
+            Scheduler &operator=(Scheduler const &) = delete;
+            //Removes every task
+            ~Scheduler();
+        private:
+            //Sorted by priority (highest first), then by the order added
+            Task *pm_head = nullptr;
+        };
+
+    } //time
+
+//Type aliases
+    using Scheduler1k = time::Scheduler<1000>;
+
+} //libmodule
+
+template <size_t tickFrequency_c /*= 1000*/>
+void libmodule::time::Scheduler<tickFrequency_c>::update()
+{
+    for(Task *task = pm_head; task != nullptr; task = task->pm_next) {
+        tick_t const now = Clock_t::now();
+        if(!Clock_t::reached(task->pm_due))
+            continue;
+        //A whole period late means a run was missed: count it, and continue the schedule from now
+        if(task->period != 0 && now - task->pm_due >= task->period) {
+            if(task->overruns < UINT16_MAX) task->overruns++;
+            task->pm_due = now;
+        }
+        task->pm_due += task->period;
+#ifdef LIBMODULE_SCHEDULER_STATS
+        CaptureStopwatch::us_t const start = CaptureStopwatch::now();
+        task->task_run();
+        CaptureStopwatch::us_t const took = CaptureStopwatch::now() - start;
+        if(took > task->worstMicros)
+            task->worstMicros = took;
+#else
+        task->task_run();
+#endif
+    }
+}
+
+template <size_t tickFrequency_c /*= 1000*/>
+void libmodule::time::Scheduler<tickFrequency_c>::add(Task *const task)
+{
+    if(task == nullptr) hw::panic();
+    if(task->pm_scheduler != nullptr)
+        task->pm_scheduler->remove(task);
+    task->pm_scheduler = this;
+    task->pm_due = Clock_t::now();
+    //Insert after the tasks of the same or higher priority
+    Task **link = &pm_head;
+    while(*link != nullptr && (*link)->priority >= task->priority)
+        link = &((*link)->pm_next);
+    task->pm_next = *link;
+    *link = task;
+}
+
+template <size_t tickFrequency_c /*= 1000*/>
+void libmodule::time::Scheduler<tickFrequency_c>::remove(Task *const task)
+{
+    if(task == nullptr || task->pm_scheduler != this)
+        return;
+    task->pm_scheduler = nullptr;
+    for(Task **link = &pm_head; *link != nullptr; link = &((*link)->pm_next)) {
+        if(*link == task) {
+            *link = task->pm_next;
+            task->pm_next = nullptr;
+            return;
+        }
+    }
+}
+
+template <size_t tickFrequency_c /*= 1000*/>
+typename libmodule::time::Scheduler<tickFrequency_c>::tick_t libmodule::time::Scheduler<tickFrequency_c>::ticks_until_due() const
+{
+    tick_t rtrn = UINT32_MAX;
+    tick_t const now = Clock_t::now();
+    for(Task const *task = pm_head; task != nullptr; task = task->pm_next) {
+        tick_t const remaining = static_cast<int32_t>(task->pm_due - now) > 0 ? task->pm_due - now : 0;
+        if(remaining < rtrn) rtrn = remaining;
+    }
+    return rtrn;
+}
+
+template <size_t tickFrequency_c /*= 1000*/>
+libmodule::time::Scheduler<tickFrequency_c>::~Scheduler()
+{
+    while(pm_head != nullptr)
+        remove(pm_head);
+}
+
+template <size_t tickFrequency_c /*= 1000*/>
+libmodule::time::Scheduler<tickFrequency_c>::Task::Task(uint16_t const period, uint8_t const priority /*= 0*/) : period(period), priority(priority) {}
+
+template <size_t tickFrequency_c /*= 1000*/>
+libmodule::time::Scheduler<tickFrequency_c>::Task::~Task()
+{
+    if(pm_scheduler != nullptr)
+        pm_scheduler->remove(this);
+}
+
+template <size_t tickFrequency_c /*= 1000*/>
+template <typename T>
+void libmodule::time::Scheduler<tickFrequency_c>::Task_MemFnCallback<T>::task_run()
+{
+    if(callback_ptr != nullptr && callback != nullptr) (callback_ptr->*callback)();
+}
+
+template <size_t tickFrequency_c /*= 1000*/>
+template <typename T>
+libmodule::time::Scheduler<tickFrequency_c>::Task_MemFnCallback<T>::Task_MemFnCallback(T *const callback_ptr, callback_t const callback, uint16_t const period, uint8_t const priority /*= 0*/)
+    : Task(period, priority), callback_ptr(callback_ptr), callback(callback) {}
@@ -4,3 +4,33 @@
  * Created: 4/12/2018 10:11:53 AM
  *  Author: teddy
  */
+
+#include "timer.h"
+
+uint16_t libmodule::time::TimerStats::averageDuration() const
+{
+    return averageDuration16 >> 4;
+}
+
+uint16_t libmodule::time::TimerStats::jitter() const
+{
+    return ticks == 0 ? 0 : worstLatency - bestLatency;
+}
+
+uint32_t libmodule::time::idle(uint32_t const max_ticks /*= UINT32_MAX*/)
+{
+    uint32_t rtrn = 0;
+    //Interrupts have to stay disabled from finding the next deadline to sleeping, otherwise a timer could be scheduled in between.
+    //Not an LM_ATOMIC_BLOCK, as interrupts are enabled while sleeping, and the time slept isn't interrupt latency.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        using Base = TimerBase<LIBMODULE_TIMER_BASE_FREQUENCY>;
+        uint32_t ticks = Base::tq_ticks_until_next();
+        if(ticks > max_ticks) ticks = max_ticks;
+        //The tick the deadline is on is handled by the tick interrupt as usual
+        if(ticks > 1) {
+            rtrn = hw::timer_sleep(ticks - 1);
+            Base::tq_handle_ticks(rtrn);
+        }
+    }
+    return rtrn;
+}
@@ -24,15 +24,26 @@ namespace libmodule
         //Timers are organized as follows
         //(this could be better - in particular, allowing multiple user provided implementations for each frequency)
         //
+        //---TimerQueue---
+        // - TimerQueue (timercommon.h) has a template with "TickFrequency_c".
+        // - It keeps a tick counter and a deadline sorted list of the scheduled timers of -that particular frequency-
+        // - Each tick, only the timers that are due are expired, so timers that aren't running (or aren't due) cost nothing
+        // - Expiring a timer is inlined into the ISR (it sets TimerQueue::finished and clears TimerQueue::running), so nothing in here is virtual
+        //
         //---TimerBase---
-        // - TimerBase has a template with "TickFrequency_c".
-        // - Since it inherits from InstanceList, all timers of -that particular frequency- are kept in a list
-        // - Specializations of TimerBase are added for each different TickFrequency
+        // - Specializations of TimerBase are added for each TickFrequency the hardware provides, and inherit from TimerQueue
         // - These specializations implement the timer on the hardware using static functions
-        // - These static functions will take care of calling tick() for all instances of that frequency when needed
+        // - These static functions will take care of calling TimerQueue::tq_handle_tick() when needed
+        // - Any other TickFrequency is divided down from TimerBase<LIBMODULE_TIMER_BASE_FREQUENCY>, so it doesn't need its own hardware timer
         //
         //---Timer---
         // - Timer allows timers of different tick_t to be counted as instances of the same frequency
+        // - A running Timer is scheduled in the queue, and is expired by it
+        // - A Stopwatch is never scheduled, so it isn't a TimerQueue. Its ticks are measured from the Clock.
+        //
+        //---Clock/DeadlineTimer---
+        // - Clock reads the TimerQueue tick counter (uptime) of a frequency
+        // - A DeadlineTimer only stores the tick count it finishes at, and is never scheduled, so it costs the ISR nothing
 
         template <size_t tickFrequency_c = 1000, typename tick_t = uint16_t>
         class Timer : public TimerBase<tickFrequency_c>
@@ -40,37 +51,132 @@ namespace libmodule
         public:
             //Returns whether the timer is finished or not
             inline operator bool() const;
+            //Returns ticks()
             inline operator tick_t() const;
+            //Sets the ticks remaining. If the timer is running, it continues from the new value.
             inline Timer &operator=(tick_t const p0);
 
             //Starts the timer
-            virtual void start();
+            void start();
             //Stops (pauses) the timer
-            virtual void stop();
+            void stop();
             //Resets (sets everything to default value) the timer
             void reset();
+            //[atomic] Returns the ticks remaining
+            tick_t ticks() const;
 
-            volatile tick_t ticks = 0;
-            volatile bool finished : 1;
-            volatile bool running : 1;
-
+            //finished and running are inherited from TimerQueue
         protected:
-            //Called when 1 tick interval has elapsed
-            virtual void tick() override;
+            //Ticks remaining while the timer is not running (0 while running, the queue holds the deadline)
+            tick_t pm_ticks = 0;
         };
 
+        //Uptime of the daemon of a TickFrequency, as a free-running 32-bit tick counter.
+        template <size_t tickFrequency_c = 1000>
+        struct Clock {
+            using tick_t = typename TimerBase<tickFrequency_c>::tq_tick_t;
+            static constexpr size_t frequency = tickFrequency_c;
+
+            //Returns the ticks since the daemon was started. Tear-free, ISR-safe, and does not disable interrupts.
+            static tick_t now();
+            //Returns whether deadline has been reached. Correct across wraparound, as long as deadline is within 2^31 ticks of now.
+            static bool reached(tick_t const deadline);
+        };
+
+        //Counts up from when it was started. Its ticks are measured from Clock, so the daemon never touches it.
         template <size_t tickFrequency_c = 1000, typename tick_t = uint16_t>
-        class Stopwatch : public Timer<tickFrequency_c, tick_t>
+        class Stopwatch
         {
         public:
-            //TODO: Why does this work? (extension? Why isn't it the norm?)
-            using Timer<tickFrequency_c, tick_t>::operator =;
-            //using Timer<tickFrequency_c, tick_t>::operator tick_t const;
-            void start() override;
+            //Returns ticks()
+            inline operator tick_t() const;
+            //Sets the ticks counted. If the stopwatch is running, it continues from the new value.
+            inline Stopwatch &operator=(tick_t const p0);
+
+            //Starts (or continues) counting
+            void start();
+            //Stops (pauses) counting
+            void stop();
+            //Stops the stopwatch and sets the ticks counted to 0
+            void reset();
+            //Returns the ticks counted. Tear-free without disabling interrupts, since a Stopwatch is not modified by the daemon.
+            tick_t ticks() const;
+            //Returns the ticks counted, and counts again from 0 from the same Clock tick (so no ticks are lost between the two)
+            tick_t lap();
+
+            bool running = false;
         protected:
-            void tick() override;
+            //The Clock tick at which ticks() would have been 0
+            typename Clock<tickFrequency_c>::tick_t pm_origin = 0;
+            //Ticks counted while the stopwatch is not running
+            tick_t pm_ticks = 0;
+        };
+
+        //Timer that stores only the Clock tick it finishes at. Checking it is a comparison against Clock::now().
+        //Unlike Timer, it can't be paused, and it does not need to be registered with the daemon.
+        //Default constructed, it is finished. The deadline is compared with wraparound, so a started timer has to be checked within 2^31 ticks of it (~24.8 days at 1kHz).
+        template <size_t tickFrequency_c = 1000>
+        class DeadlineTimer
+        {
+        public:
+            using Clock_t = Clock<tickFrequency_c>;
+            using tick_t = typename Clock_t::tick_t;
+
+            //Returns whether the deadline has been reached
+            inline operator bool() const;
+            bool finished() const;
+            //Returns the ticks until the deadline, or 0 if finished
+            tick_t remaining() const;
+
+            //Sets the deadline ticks from now
+            void start(tick_t const ticks);
+            //Moves the deadline ticks past the previous deadline. Use this for periodic events, so that they don't drift with update() latency.
+            void advance(tick_t const ticks);
+
+            //The Clock tick the timer finishes at
+            tick_t deadline = 0;
+            //Whether the deadline is still to be reached. Cleared by finished(), so that the deadline isn't compared again once it has passed.
+            mutable bool running = false;
+        };
+
+        //Microsecond timestamps, from the ticks of LIBMODULE_TIMER_BASE_FREQUENCY and the hardware timer count within the tick (hw::timer_counter()).
+        //Used to time pulses (e.g. for a SpeedMonitor) more finely than the tick, by calling capture() from an input capture or pin change interrupt.
+        //Like DeadlineTimer, it is never scheduled, so it costs the tick ISR nothing.
+        class CaptureStopwatch
+        {
+        public:
+            //Wraps around after ~71 minutes. Differences are correct across the wraparound.
+            using us_t = uint32_t;
+            static constexpr us_t usPerTick_c = 1000000 / LIBMODULE_TIMER_BASE_FREQUENCY;
+            static_assert(1000000 % LIBMODULE_TIMER_BASE_FREQUENCY == 0, "CaptureStopwatch needs a whole number of microseconds per tick");
+
+            //[atomic] Returns the current timestamp. Tear-free, and safe to call from an ISR (including while the tick interrupt is pending).
+            static inline us_t now();
+
+            //[atomic] Records now() as the latest capture. Safe to call from an ISR.
+            inline void capture();
+            //[atomic] Returns whether there has been a capture since the last call of period()
+            inline bool available() const;
+            //[atomic] Returns the time between the last two captures (0 if there have been fewer than two), and clears available().
+            inline us_t period();
+            //[atomic] Returns the time since the last capture (0 if there hasn't been one)
+            inline us_t elapsed() const;
+            //[atomic] Forgets the captures
+            inline void reset();
+        private:
+            us_t pm_previous = 0;
+            us_t pm_last = 0;
+            //Number of captures, up to 2
+            uint8_t pm_captures = 0;
+            bool pm_available = false;
         };
 
+        //Sleeps (see hw::timer_sleep()) with the tick interrupt stopped until the tick a Timer of any frequency expires on,
+        //another interrupt wakes the MCU, or max_ticks ticks of LIBMODULE_TIMER_BASE_FREQUENCY have passed.
+        //Anything else that is measured with Clock (e.g. DeadlineTimer, Scheduler) isn't known to the timer queues, so pass the time until it is due as max_ticks.
+        //Returns the number of ticks slept.
+        uint32_t idle(uint32_t const max_ticks = UINT32_MAX);
+
         //---Implementation---
 
         //Initializes/starts the daemons for the timers of the given TickFrequencies
@@ -83,82 +189,251 @@ namespace libmodule
         template <size_t tickFrequency_c, typename tick_t /*= uint16_t*/>
         Timer<tickFrequency_c, tick_t>::operator tick_t() const
         {
-            return ticks;
+            return ticks();
         }
 
         template <size_t tickFrequency_c, typename tick_t /*= uint16_t*/>
         Timer<tickFrequency_c, tick_t>::operator bool() const
         {
-            return finished;
+            return this->finished;
         }
 
         template <size_t tickFrequency_c, typename tick_t /*= uint16_t*/>
         Timer<tickFrequency_c, tick_t> &Timer<tickFrequency_c, tick_t>::operator=(tick_t const p0)
         {
-            ticks = p0;
+            LM_ATOMIC_BLOCK() {
+                if(!this->running)
+                    pm_ticks = p0;
+                //Restarting reschedules the timer for the new value
+                else if(p0 != 0)
+                    this->tq_schedule(p0);
+                else {
+                    this->tq_cancel();
+                    this->finished = true;
+                }
+            }
             return *this;
         }
 
         template <size_t tickFrequency_c, typename tick_t /*= uint16_t*/>
-        void Timer<tickFrequency_c, tick_t>::tick()
+        void Timer<tickFrequency_c, tick_t>::start()
         {
-            if(running && --ticks == 0) {
-                running = false;
-                finished = true;
+            LM_ATOMIC_BLOCK() {
+                if(this->running) {
+                    this->finished = false;
+                    return;
+                }
+                if(pm_ticks == 0) {
+                    this->finished = true;
+                    return;
+                }
+                this->tq_schedule(pm_ticks);
+                pm_ticks = 0;
             }
         }
 
         template <size_t tickFrequency_c, typename tick_t /*= uint16_t*/>
-        void Timer<tickFrequency_c, tick_t>::start()
+        void Timer<tickFrequency_c, tick_t>::stop()
         {
-            if(ticks == 0) {
-                running = false;
-                finished = true;
-                return;
+            LM_ATOMIC_BLOCK() {
+                if(this->running) {
+                    pm_ticks = this->tq_remaining();
+                    this->tq_cancel();
+                }
             }
-            running = true;
-            finished = false;
         }
 
         template <size_t tickFrequency_c, typename tick_t /*= uint16_t*/>
-        void Timer<tickFrequency_c, tick_t>::stop()
+        void Timer<tickFrequency_c, tick_t>::reset()
         {
-            running = false;
+            LM_ATOMIC_BLOCK() {
+                this->tq_cancel();
+                pm_ticks = 0;
+                this->finished = false;
+            }
         }
 
         template <size_t tickFrequency_c, typename tick_t /*= uint16_t*/>
-        void Timer<tickFrequency_c, tick_t>::reset()
+        tick_t Timer<tickFrequency_c, tick_t>::ticks() const
         {
-            ticks = 0;
-            finished = false;
-            running = false;
+            //If the timer expires after running is read, tq_remaining() sees that it isn't running and returns 0, which is also what pm_ticks is while running.
+            //pm_ticks is only changed outside of the ISR, so neither needs interrupts disabled here.
+            return this->running ? this->tq_remaining() : pm_ticks;
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/, typename tick_t /*= uint16_t*/>
+        Stopwatch<tickFrequency_c, tick_t>::operator tick_t() const
+        {
+            return ticks();
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/, typename tick_t /*= uint16_t*/>
+        Stopwatch<tickFrequency_c, tick_t> &Stopwatch<tickFrequency_c, tick_t>::operator=(tick_t const p0)
+        {
+            if(running)
+                pm_origin = Clock<tickFrequency_c>::now() - p0;
+            else
+                pm_ticks = p0;
+            return *this;
         }
 
         template <size_t tickFrequency_c /*= 1000*/, typename tick_t /*= uint16_t*/>
         void Stopwatch<tickFrequency_c, tick_t>::start()
         {
-            //I think 'this' has to be used because of the following (quoting en.cppreference dependent name page)
-            /*
-              Members of the current instantiation may be both dependent and non-dependent.
-              If the lookup of a member of current instantiation gives a different result
-              between the point of instantiation and the point of definition, the lookup is ambiguous.
-              Note however that when a member name is used, it is not automatically converted to a class member access expression,
-              only explicit member access expressions indicate members of current instantiation.
-            */
-            //Also see en.cppreference non-static member functions.
-            //Also: In class templates, this is a dependent expression, and explicit this-> may be used to force another expression to become dependent.
-            //As far as I understand:
-            // - Since running is dependent on the type of base class Timer, it is not automatically assumed to be part of the current instantiation,
-            // (during the definition phase, here), and therefore isn't converted to a member access expression.
-            // - By explicitly mentioning 'this' it is converted to a member access expression.
-            this->running = true;
+            if(!running) {
+                //Continue counting from the ticks already counted
+                pm_origin = Clock<tickFrequency_c>::now() - pm_ticks;
+                running = true;
+            }
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/, typename tick_t /*= uint16_t*/>
+        void Stopwatch<tickFrequency_c, tick_t>::stop()
+        {
+            pm_ticks = ticks();
+            running = false;
         }
 
         template <size_t tickFrequency_c /*= 1000*/, typename tick_t /*= uint16_t*/>
-        void Stopwatch<tickFrequency_c, tick_t>::tick()
+        void Stopwatch<tickFrequency_c, tick_t>::reset()
         {
-            if(this->running)
-                this->ticks++;
+            running = false;
+            pm_ticks = 0;
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/, typename tick_t /*= uint16_t*/>
+        tick_t Stopwatch<tickFrequency_c, tick_t>::lap()
+        {
+            if(!running) {
+                tick_t const rtrn = pm_ticks;
+                pm_ticks = 0;
+                return rtrn;
+            }
+            auto const now = Clock<tickFrequency_c>::now();
+            tick_t const rtrn = static_cast<tick_t>(now - pm_origin);
+            pm_origin = now;
+            return rtrn;
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/, typename tick_t /*= uint16_t*/>
+        tick_t Stopwatch<tickFrequency_c, tick_t>::ticks() const
+        {
+            //Wraps around like a counter of type tick_t would
+            return running ? static_cast<tick_t>(Clock<tickFrequency_c>::now() - pm_origin) : pm_ticks;
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/>
+        typename Clock<tickFrequency_c>::tick_t Clock<tickFrequency_c>::now()
+        {
+            return TimerBase<tickFrequency_c>::tq_now();
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/>
+        bool Clock<tickFrequency_c>::reached(tick_t const deadline)
+        {
+            return static_cast<int32_t>(now() - deadline) >= 0;
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/>
+        DeadlineTimer<tickFrequency_c>::operator bool() const
+        {
+            return finished();
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/>
+        bool DeadlineTimer<tickFrequency_c>::finished() const
+        {
+            if(running && Clock_t::reached(deadline))
+                running = false;
+            return !running;
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/>
+        typename DeadlineTimer<tickFrequency_c>::tick_t DeadlineTimer<tickFrequency_c>::remaining() const
+        {
+            if(!running) return 0;
+            tick_t const diff = deadline - Clock_t::now();
+            return static_cast<int32_t>(diff) > 0 ? diff : 0;
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/>
+        void DeadlineTimer<tickFrequency_c>::start(tick_t const ticks)
+        {
+            deadline = Clock_t::now() + ticks;
+            running = true;
+        }
+
+        template <size_t tickFrequency_c /*= 1000*/>
+        void DeadlineTimer<tickFrequency_c>::advance(tick_t const ticks)
+        {
+            deadline += ticks;
+            running = true;
+        }
+
+        //These are inline so that the hw::timer_counter() hooks are only needed if CaptureStopwatch is used
+        CaptureStopwatch::us_t CaptureStopwatch::now()
+        {
+            TimerQueue<LIBMODULE_TIMER_BASE_FREQUENCY>::tq_tick_t ticks;
+            uint16_t counter;
+            LM_ATOMIC_BLOCK() {
+                ticks = TimerBase<LIBMODULE_TIMER_BASE_FREQUENCY>::tq_now();
+                counter = hw::timer_counter();
+                //If the counter has wrapped but the tick interrupt hasn't run yet (e.g. when called from another ISR), the tick count is one behind.
+                //The counter is read again, since it may have wrapped after the first read.
+                if(hw::timer_tick_pending()) {
+                    ticks++;
+                    counter = hw::timer_counter();
+                }
+            }
+            return ticks * usPerTick_c + static_cast<us_t>(counter) * usPerTick_c / hw::timer_counter_period();
+        }
+
+        void CaptureStopwatch::capture()
+        {
+            us_t const timestamp = now();
+            LM_ATOMIC_BLOCK() {
+                pm_previous = pm_last;
+                pm_last = timestamp;
+                if(pm_captures < 2) pm_captures++;
+                pm_available = true;
+            }
+        }
+
+        bool CaptureStopwatch::available() const
+        {
+            bool rtrn;
+            LM_ATOMIC_BLOCK() {
+                rtrn = pm_available;
+            }
+            return rtrn;
+        }
+
+        CaptureStopwatch::us_t CaptureStopwatch::period()
+        {
+            us_t rtrn = 0;
+            LM_ATOMIC_BLOCK() {
+                if(pm_captures >= 2) rtrn = pm_last - pm_previous;
+                pm_available = false;
+            }
+            return rtrn;
+        }
+
+        CaptureStopwatch::us_t CaptureStopwatch::elapsed() const
+        {
+            us_t last;
+            LM_ATOMIC_BLOCK() {
+                if(pm_captures == 0) return 0;
+                last = pm_last;
+            }
+            return now() - last;
+        }
+
+        void CaptureStopwatch::reset()
+        {
+            LM_ATOMIC_BLOCK() {
+                pm_captures = 0;
+                pm_available = false;
+            }
         }
 
     } //timer
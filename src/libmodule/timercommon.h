@@ -9,20 +9,378 @@
 
 #include <stdlib.h>
 
+#include "utility.h"
+
+//Frequency of the hardware daemon that frequencies without a hardware TimerBase are divided down from
+#ifndef LIBMODULE_TIMER_BASE_FREQUENCY
+#define LIBMODULE_TIMER_BASE_FREQUENCY 1000
+#endif
+
 namespace libmodule
 {
-    namespace time
+    namespace hw
     {
+        //Provided by the hardware specific repository, but only needed when used (e.g. when LIBMODULE_TIMER_STATS or LIBMODULE_SCHEDULER_STATS is defined).
+        //They describe the hardware timer driving TimerBase<LIBMODULE_TIMER_BASE_FREQUENCY>.
 
-//Empty specialization
-        template <size_t TickFrequency_c>
-        class TimerBase;
+        //Count of the hardware timer, from 0 at the start of a tick to timer_counter_period() - 1
+        uint16_t timer_counter();
+        //Counts per tick
+        uint16_t timer_counter_period();
+        //Whether the next tick is already due (its interrupt is pending)
+        bool timer_tick_pending();
+        //Called by time::idle() with interrupts disabled.
+        //Stops the tick interrupt and sleeps (with interrupts enabled) until ticks ticks have passed, or another interrupt wakes the MCU.
+        //Then restarts the tick interrupt in phase with the ticks that passed, and returns with interrupts disabled.
+        //Returns the number of whole ticks that passed. If the hardware can't do this, it can return 0 straight away.
+        uint32_t timer_sleep(uint32_t const ticks);
+    }
 
+    namespace time
+    {
 //Declare start_timer_daemon for friend statement
         template<size_t ...>
         void start_timer_daemons();
 //TODO: Add start_timer_daemons that takes timer types as arguments and deduces the size_t
 //e.g. start_timer_daemons<Timer1k>();
 
+        //A slower TimerQueue that is ticked from the tick of a faster one, once every divider ticks.
+        struct TimerPrescaler {
+            void (*handle_tick)();
+            void (*handle_ticks)(uint32_t const ticks);
+            uint32_t (*ticks_until_next)();
+            uint16_t divider;
+            uint16_t count;
+            TimerPrescaler *next;
+        };
+
+        //Statistics of the daemon of one TickFrequency, recorded when LIBMODULE_TIMER_STATS is defined.
+        //Durations and latencies are in counts of hw::timer_counter().
+        struct TimerStats {
+            //Ticks recorded
+            uint32_t ticks;
+            //Timers expired
+            uint32_t expired;
+            //Ticks that were still being handled when the next tick was due (that tick was late, and any after it lost)
+            uint16_t missedTicks;
+            //Duration of tq_handle_tick(), including the frequencies divided from it.
+            uint16_t worstDuration;
+            //Exponential moving average (weight 1/16) of the duration, times 16
+            uint32_t averageDuration16;
+            //Latency from the hardware tick to the start of tq_handle_tick()
+            uint16_t bestLatency;
+            uint16_t worstLatency;
+
+            uint16_t averageDuration() const;
+            //Tick-to-tick variation in when the daemon runs
+            uint16_t jitter() const;
+        };
+
+        //Keeps the scheduled timers of one TickFrequency in a list sorted by deadline, over a free-running tick counter.
+        //Each tick the daemon only increments the counter and looks at the head of the list, so the ISR cost is
+        //proportional to the number of timers expiring on that tick, not the number of timers that exist.
+        //Scheduling is O(number of scheduled timers), but happens outside of the ISR.
+        //Deadlines are compared with wraparound, so a timer can be scheduled up to 2^32 - 1 ticks ahead.
+        //Expiring a timer only sets its flags, so the ISR is a fixed inlined loop: there are no virtual calls, and no vtable pointer per timer.
+        template <size_t TickFrequency_c>
+        class TimerQueue
+        {
+        public:
+            using tq_tick_t = uint32_t;
+
+            //Returns the number of ticks since the daemon was started (wraps around).
+            //Tear-free without disabling interrupts, and safe to call from an ISR.
+            static tq_tick_t tq_now();
+            //Advances the counter by one tick, expires any timers that are due, then ticks any prescalers that are due.
+            //Called by the daemon (from the ISR).
+            static void tq_handle_tick();
+            //Advances the counter by ticks ticks at once, expiring any timers that were due in that time.
+            //Used when the tick interrupt was stopped for those ticks (see time::idle()).
+            static void tq_handle_ticks(tq_tick_t const ticks);
+            //[atomic] Returns the ticks until the next timer of this frequency (or a frequency divided from it) expires, in ticks of this frequency.
+            //Returns UINT32_MAX if no timers are scheduled.
+            static tq_tick_t tq_ticks_until_next();
+            //[atomic] Adds a prescaler to be ticked from the tick of this frequency. prescaler must stay alive from then on.
+            static void tq_add_prescaler(TimerPrescaler &prescaler);
+#ifdef LIBMODULE_TIMER_STATS
+            //[atomic] Returns the statistics recorded since the daemon started (or since tq_reset_stats())
+            static TimerStats tq_stats();
+            //[atomic]
+            static void tq_reset_stats();
+#endif
+
+            //Both are written by the ISR and the main loop, so they are separate bytes (as bitfields, writing one from the main loop could overwrite the ISR's write to the other).
+            //Set by the ISR when the deadline is reached
+            volatile bool finished;
+            //Whether this is scheduled in the queue. Cleared by the ISR when the deadline is reached.
+            volatile bool running;
+
+            TimerQueue();
+            //Copies are never scheduled
+            TimerQueue(TimerQueue const &p);
+            TimerQueue &operator=(TimerQueue const &p);
+            //[atomic] Removes this from the queue.
+            ~TimerQueue();
+        protected:
+            //[atomic] Schedules this to expire in ticks ticks (must be > 0), sets running and clears finished. If already scheduled, it is rescheduled.
+            void tq_schedule(tq_tick_t const ticks);
+            //[atomic] Removes this from the queue, if scheduled, and clears running.
+            void tq_cancel();
+            //[atomic] Returns the ticks left until expiry, or 0 if not scheduled.
+            tq_tick_t tq_remaining() const;
+        private:
+            TimerQueue *tq_next = nullptr;
+            tq_tick_t tq_deadline = 0;
+
+            static TimerQueue *tq_head;
+            static utility::Atomic<tq_tick_t> tq_ticks;
+            static TimerPrescaler *tq_prescalers;
+#ifdef LIBMODULE_TIMER_STATS
+            static TimerStats tq_statistics;
+            //Called at the end of tq_handle_tick()
+            static void tq_record_stats(uint16_t const entry, uint8_t const expired);
+#endif
+        };
+
+        template <size_t TickFrequency_c>
+        TimerQueue<TickFrequency_c> *TimerQueue<TickFrequency_c>::tq_head = nullptr;
+        template <size_t TickFrequency_c>
+        utility::Atomic<typename TimerQueue<TickFrequency_c>::tq_tick_t> TimerQueue<TickFrequency_c>::tq_ticks;
+        template <size_t TickFrequency_c>
+        TimerPrescaler *TimerQueue<TickFrequency_c>::tq_prescalers = nullptr;
+#ifdef LIBMODULE_TIMER_STATS
+        template <size_t TickFrequency_c>
+        TimerStats TimerQueue<TickFrequency_c>::tq_statistics = {0, 0, 0, 0, 0, UINT16_MAX, 0};
+#endif
+
+        //The hardware specific TimerBase<TickFrequency_c> specializations must inherit from TimerQueue<TickFrequency_c>,
+        //and have their daemon call TimerQueue<TickFrequency_c>::tq_handle_tick() once per tick.
+        //start_daemon() may be called more than once, and should only start the hardware the first time.
+        //
+        //Every other frequency uses this template, which is divided down from TimerBase<LIBMODULE_TIMER_BASE_FREQUENCY>.
+        //This way one hardware timer (and interrupt) drives e.g. 1kHz, 100Hz and 10Hz timers, and the 10Hz timers only cost work at 10Hz.
+        template <size_t TickFrequency_c>
+        class TimerBase : public TimerQueue<TickFrequency_c>
+        {
+            template <size_t ...>
+            friend void start_timer_daemons();
+        public:
+            static constexpr size_t baseFrequency_c = LIBMODULE_TIMER_BASE_FREQUENCY;
+            static_assert(TickFrequency_c != baseFrequency_c, "The hardware does not provide a TimerBase for LIBMODULE_TIMER_BASE_FREQUENCY");
+            static_assert(TickFrequency_c < baseFrequency_c && baseFrequency_c % TickFrequency_c == 0, "TickFrequency must divide LIBMODULE_TIMER_BASE_FREQUENCY");
+            static_assert(baseFrequency_c / TickFrequency_c <= UINT16_MAX, "TickFrequency is too low for LIBMODULE_TIMER_BASE_FREQUENCY");
+        private:
+            //Starts the base daemon, and adds this frequency as a prescaler of it
+            static void start_daemon();
+        };
+
     } //time
 } //libmodule
+
+template <size_t TickFrequency_c>
+typename libmodule::time::TimerQueue<TickFrequency_c>::tq_tick_t libmodule::time::TimerQueue<TickFrequency_c>::tq_now()
+{
+    //tq_ticks is wider than the AVR can read in one instruction, so the daemon could update it part way through a read (see utility::Atomic)
+    return tq_ticks.load();
+}
+
+template <size_t TickFrequency_c>
+void libmodule::time::TimerQueue<TickFrequency_c>::tq_handle_tick()
+{
+#ifdef LIBMODULE_TIMER_STATS
+    uint16_t const entry = hw::timer_counter();
+    uint8_t expiredcount = 0;
+#endif
+    tq_tick_t const now = tq_ticks.fetch_add(1) + 1;
+    //Nothing in the queue can be due before now, so only the head needs to be checked
+    while(tq_head != nullptr && tq_head->tq_deadline == now) {
+        TimerQueue *const expired = tq_head;
+        tq_head = expired->tq_next;
+        expired->tq_next = nullptr;
+        expired->running = false;
+        expired->finished = true;
+#ifdef LIBMODULE_TIMER_STATS
+        expiredcount++;
+#endif
+    }
+    for(TimerPrescaler *prescaler = tq_prescalers; prescaler != nullptr; prescaler = prescaler->next) {
+        if(++prescaler->count == prescaler->divider) {
+            prescaler->count = 0;
+            prescaler->handle_tick();
+        }
+    }
+#ifdef LIBMODULE_TIMER_STATS
+    tq_record_stats(entry, expiredcount);
+#endif
+}
+
+template <size_t TickFrequency_c>
+void libmodule::time::TimerQueue<TickFrequency_c>::tq_handle_ticks(tq_tick_t const ticks)
+{
+    if(ticks == 0) return;
+    tq_tick_t const previous = tq_ticks.fetch_add(ticks);
+    //Every deadline in the queue is after previous
+    while(tq_head != nullptr && static_cast<tq_tick_t>(tq_head->tq_deadline - previous) <= ticks) {
+        TimerQueue *const expired = tq_head;
+        tq_head = expired->tq_next;
+        expired->tq_next = nullptr;
+        expired->running = false;
+        expired->finished = true;
+    }
+    for(TimerPrescaler *prescaler = tq_prescalers; prescaler != nullptr; prescaler = prescaler->next) {
+        tq_tick_t prescaled = ticks / prescaler->divider;
+        //Summed in tq_tick_t: count and the remainder are each below divider, so in uint16_t the sum can wrap
+        tq_tick_t count = static_cast<tq_tick_t>(prescaler->count) + ticks % prescaler->divider;
+        if(count >= prescaler->divider) {
+            count -= prescaler->divider;
+            prescaled++;
+        }
+        prescaler->count = static_cast<uint16_t>(count);
+        prescaler->handle_ticks(prescaled);
+    }
+}
+
+template <size_t TickFrequency_c>
+typename libmodule::time::TimerQueue<TickFrequency_c>::tq_tick_t libmodule::time::TimerQueue<TickFrequency_c>::tq_ticks_until_next()
+{
+    tq_tick_t rtrn = UINT32_MAX;
+    LM_ATOMIC_BLOCK() {
+        if(tq_head != nullptr)
+            rtrn = tq_head->tq_deadline - tq_ticks.load();
+        for(TimerPrescaler *prescaler = tq_prescalers; prescaler != nullptr; prescaler = prescaler->next) {
+            tq_tick_t const next = prescaler->ticks_until_next();
+            if(next == UINT32_MAX) continue;
+            //The first prescaled tick is (divider - count) ticks away, and the ones after it are divider ticks apart
+            tq_tick_t const first = prescaler->divider - prescaler->count;
+            if(next - 1 >= (UINT32_MAX - first) / prescaler->divider) continue;
+            tq_tick_t const ticks = first + (next - 1) * prescaler->divider;
+            if(ticks < rtrn) rtrn = ticks;
+        }
+    }
+    return rtrn;
+}
+
+template <size_t TickFrequency_c>
+void libmodule::time::TimerQueue<TickFrequency_c>::tq_add_prescaler(TimerPrescaler &prescaler)
+{
+    LM_ATOMIC_BLOCK() {
+        prescaler.count = 0;
+        prescaler.next = tq_prescalers;
+        tq_prescalers = &prescaler;
+    }
+}
+
+#ifdef LIBMODULE_TIMER_STATS
+template <size_t TickFrequency_c>
+libmodule::time::TimerStats libmodule::time::TimerQueue<TickFrequency_c>::tq_stats()
+{
+    TimerStats rtrn;
+    LM_ATOMIC_BLOCK() {
+        rtrn = tq_statistics;
+    }
+    return rtrn;
+}
+
+template <size_t TickFrequency_c>
+void libmodule::time::TimerQueue<TickFrequency_c>::tq_reset_stats()
+{
+    LM_ATOMIC_BLOCK() {
+        tq_statistics = {0, 0, 0, 0, 0, UINT16_MAX, 0};
+    }
+}
+
+template <size_t TickFrequency_c>
+void libmodule::time::TimerQueue<TickFrequency_c>::tq_record_stats(uint16_t const entry, uint8_t const expired)
+{
+    uint16_t const exit = hw::timer_counter();
+    //If the ISR ran past the next tick, the counter has started again from 0 (assumes it didn't run past two)
+    bool const missed = hw::timer_tick_pending();
+    uint16_t const duration = missed || exit < entry ? hw::timer_counter_period() - entry + exit : exit - entry;
+
+    TimerStats &stats = tq_statistics;
+    stats.ticks++;
+    stats.expired += expired;
+    if(missed && stats.missedTicks < UINT16_MAX) stats.missedTicks++;
+    if(duration > stats.worstDuration) stats.worstDuration = duration;
+    //Starts at the first duration, rather than working its way up from 0
+    if(stats.ticks == 1) stats.averageDuration16 = static_cast<uint32_t>(duration) << 4;
+    else stats.averageDuration16 += duration - static_cast<int32_t>(stats.averageDuration16 >> 4);
+    if(entry < stats.bestLatency) stats.bestLatency = entry;
+    if(entry > stats.worstLatency) stats.worstLatency = entry;
+}
+#endif
+
+template <size_t TickFrequency_c>
+libmodule::time::TimerQueue<TickFrequency_c>::TimerQueue() : finished(false), running(false) {}
+
+template <size_t TickFrequency_c>
+libmodule::time::TimerQueue<TickFrequency_c>::TimerQueue(TimerQueue const &p) : finished(p.finished), running(false) {}
+
+template <size_t TickFrequency_c>
+libmodule::time::TimerQueue<TickFrequency_c> &libmodule::time::TimerQueue<TickFrequency_c>::operator=(TimerQueue const &p)
+{
+    finished = p.finished;
+    return *this;
+}
+
+template <size_t TickFrequency_c>
+libmodule::time::TimerQueue<TickFrequency_c>::~TimerQueue()
+{
+    tq_cancel();
+}
+
+template <size_t TickFrequency_c>
+void libmodule::time::TimerQueue<TickFrequency_c>::tq_schedule(tq_tick_t const ticks)
+{
+    if(ticks == 0) hw::panic();
+    LM_ATOMIC_BLOCK() {
+        tq_cancel();
+        tq_tick_t const now = tq_ticks.load();
+        tq_deadline = now + ticks;
+        //Find the first timer that expires after this one (timers with the same deadline expire in the order they were scheduled)
+        TimerQueue **link = &tq_head;
+        while(*link != nullptr && static_cast<tq_tick_t>((*link)->tq_deadline - now) <= ticks)
+            link = &((*link)->tq_next);
+        tq_next = *link;
+        *link = this;
+        running = true;
+        finished = false;
+    }
+}
+
+template <size_t TickFrequency_c>
+void libmodule::time::TimerQueue<TickFrequency_c>::tq_cancel()
+{
+    LM_ATOMIC_BLOCK() {
+        if(running) {
+            TimerQueue **link = &tq_head;
+            while(*link != this)
+                link = &((*link)->tq_next);
+            *link = tq_next;
+            tq_next = nullptr;
+            running = false;
+        }
+    }
+}
+
+template <size_t TickFrequency_c>
+typename libmodule::time::TimerQueue<TickFrequency_c>::tq_tick_t libmodule::time::TimerQueue<TickFrequency_c>::tq_remaining() const
+{
+    tq_tick_t rtrn = 0;
+    LM_ATOMIC_BLOCK() {
+        if(running)
+            rtrn = tq_deadline - tq_ticks.load();
+    }
+    return rtrn;
+}
+
+template <size_t TickFrequency_c>
+void libmodule::time::TimerBase<TickFrequency_c>::start_daemon()
+{
+    static bool started = false;
+    if(started) return;
+    started = true;
+    static TimerPrescaler prescaler = {&TimerBase::tq_handle_tick, &TimerBase::tq_handle_ticks, &TimerBase::tq_ticks_until_next, baseFrequency_c / TickFrequency_c, 0, nullptr};
+    TimerQueue<baseFrequency_c>::tq_add_prescaler(prescaler);
+    start_timer_daemons<baseFrequency_c>();
+}
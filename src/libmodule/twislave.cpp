@@ -19,7 +19,7 @@ void libmodule::twi::SlaveBufferManager::update()
     twislave.set_callbacks(this);
     TWISlave::Result result;
     TWISlave::TransactionInfo transaction;
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    LM_ATOMIC_BLOCK() {
         result = twislave.result();
         transaction = twislave.lastTransaction();
     }
@@ -40,6 +40,7 @@ void libmodule::twi::SlaveBufferManager::update()
             //Copy in the header, if it exists (maybe move this to when !communicating())
             if(pm_header != nullptr && pm_headerlen > 0)
                 memcpy(pm_sendbuf.buf, pm_header, pm_headerlen);
+            pm_sendbuf_stale = true;
             twislave.set_sendBuffer(pm_sendbuf.buf, pm_sendbuf.len);
         }
         //+1 for regaddr
@@ -80,10 +81,37 @@ void libmodule::twi::SlaveBufferManager::set_timeout(size_t const timeout)
 
 void libmodule::twi::SlaveBufferManager::update_sendbuf()
 {
-    //Copy in the data, with the data at regaddr first
-    memcpy(pm_sendbuf.buf + pm_headerlen, buffer.pm_ptr + pm_regaddr, buffer.pm_len - pm_regaddr);
-    //Set the memory past the end of the buffer to zero
-    memset(pm_sendbuf.buf + pm_sendbuf.len - pm_regaddr, 0, pm_regaddr);
+    //Only the bytes written since the last update need to be copied, unless the layout of the sendbuf changed
+    size_t begin, end;
+    bool stale;
+    //received() (an ISR) changes pm_regaddr, so only this copy of it is used
+    uint8_t regaddr;
+    LM_ATOMIC_BLOCK() {
+        stale = pm_sendbuf_stale;
+        regaddr = pm_regaddr;
+        //If this interrupted a write (or a transaction), the bytes are left until it finishes, so that they are sent together.
+        //A changed layout can't wait (the master reads with the new regaddr next), so the whole buffer is copied, and the modified range is kept to copy again once the write finishes.
+        if(buffer.write_in_progress()) {
+            if(!stale)
+                return;
+        }
+        else {
+            begin = buffer.dirty_begin();
+            end = buffer.dirty_end();
+            buffer.clear_dirty();
+        }
+        pm_sendbuf_stale = false;
+    }
+    if(stale) {
+        begin = 0;
+        end = buffer.pm_len;
+        //Set the memory past the end of the buffer to zero
+        memset(pm_sendbuf.buf + pm_sendbuf.len - regaddr, 0, regaddr);
+    }
+    //Copy in the data, with the data at regaddr first (bytes before regaddr aren't sent)
+    if(begin < regaddr) begin = regaddr;
+    if(begin < end)
+        memcpy(pm_sendbuf.buf + pm_headerlen + (begin - regaddr), buffer.pm_ptr + begin, end - begin);
     //Example
     //pm_regaddr = 2
     //pm_sendbuf.len = 6
@@ -103,11 +131,14 @@ void libmodule::twi::SlaveBufferManager::received(uint8_t const buf[], uint8_t c
         auto regaddr = pm_recvbuf.buf[0];
         //If transaction is valid
         if(regaddr < buffer.pm_len) {
-            //Copy data from the client buffer into the sendbuf with the new regaddr
+            //Copy data from the client buffer into the sendbuf with the new regaddr (which moves every byte)
+            if(regaddr != pm_regaddr) pm_sendbuf_stale = true;
             pm_regaddr = regaddr;
             update_sendbuf();
-            //Copy data into client buffer
-            memcpy(buffer.pm_ptr + regaddr, pm_recvbuf.buf + 1, utility::tmin<uint8_t>(buffer.pm_len - regaddr, len - 1));
+            //Copy data into client buffer. It will be copied to the sendbuf on the next update.
+            uint8_t const count = utility::tmin<uint8_t>(buffer.pm_len - regaddr, len - 1);
+            memcpy(buffer.pm_ptr + regaddr, pm_recvbuf.buf + 1, count);
+            buffer.mark_dirty(regaddr, count);
         }
     }
 }
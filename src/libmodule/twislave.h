@@ -91,6 +91,7 @@ namespace libmodule
             void sent(uint8_t const buf[], uint8_t const len) override;
             void received(uint8_t const buf[], uint8_t const len) override;
 
+            //Copies the bytes of buffer that have changed (see Buffer::dirty_begin()) into the sendbuf
             void update_sendbuf();
 
             TWISlave &twislave;
@@ -106,6 +107,8 @@ namespace libmodule
                 uint8_t len = 0;
             } pm_recvbuf;
             uint8_t pm_regaddr = 0;
+            //Set when all of the sendbuf must be copied again (it was reallocated, or regaddr changed)
+            bool pm_sendbuf_stale = true;
             Timer1k pm_timer;
             size_t pm_timeout = 1000;
         };
@@ -218,13 +218,13 @@ void libmodule::ui::segdpad::ToggleList::ui_update()
     if(pm_runinit) {
         pm_runinit = false;
         //Set the value of all the items to the default value
-        for(uint8_t i = 0; i < m_items.size(); i++) m_items[i].value = m_items[i].default_value;
+        for(Item &item : m_items) item.value = item.default_value;
     }
 
     //If any items are found with a value different to their default, the edit blink should be running.
     bool runeditblink = false;
-    for(uint8_t i = 0; i < m_items.size(); i++) {
-        if(m_items[i].value != m_items[i].default_value) {
+    for(Item const &item : m_items) {
+        if(item.value != item.default_value) {
             runeditblink = true;
             break;
         }
@@ -39,6 +39,16 @@ namespace libmodule
 {
     namespace ui
     {
+        //Container used for the items of List and ToggleList.
+        //Define LIBMODULE_UI_LIST_CAPACITY as the most items a list will have to store them inline (in a StaticVector) instead of on the heap.
+#ifdef LIBMODULE_UI_LIST_CAPACITY
+        template <typename T>
+        using ListItems = utility::StaticVector<T, LIBMODULE_UI_LIST_CAPACITY>;
+#else
+        template <typename T>
+        using ListItems = utility::Vector<T>;
+#endif
+
         struct Dpad {
             userio::RapidInput3L1k up;
             userio::RapidInput3L1k down;
@@ -130,7 +140,7 @@ namespace libmodule
                     Item_MemFnCallback(T *const callback_ptr, callback_click_t const callback_click, callback_finish_t const callback_finish = nullptr, callback_highlight_t const callback_highlight = nullptr);
                 };
 
-                utility::Vector<Item *> m_items;
+                ListItems<Item *> m_items;
                 List(bool const wrap = true, bool const enable_left = true);
             protected:
                 void ui_update() override;
@@ -160,7 +170,7 @@ namespace libmodule
                     bool value : 1;
                 };
 
-                utility::Vector<Item> m_items;
+                ListItems<Item> m_items;
                 ToggleList(bool const wrap = true);
             protected:
                 void ui_update() override;
@@ -256,7 +266,8 @@ void libmodule::ui::Screen<common_t>::ui_management_update()
     if(ui_child == nullptr) ui_update();
     else ui_child->ui_management_update();
 
-    if(ui_child->ui_finished) {
+    //ui_child is nullptr unless ui_update() spawned one
+    if(ui_child != nullptr && ui_child->ui_finished) {
         ui_on_childComplete();
         delete ui_child;
         ui_child = nullptr;
@@ -244,14 +244,14 @@ libmodule::userio::ButtonTimer<Stopwatch_t, tick_t, in_t>::operator tick_t()
 template <typename Stopwatch_t, typename tick_t /*= typename Stopwatch_tick<Stopwatch_t>::type*/, typename in_t>
 tick_t libmodule::userio::ButtonTimer<Stopwatch_t, tick_t, in_t>::heldTime()
 {
-    //Potential for error here since it's not atomic
-    return m_instates.held ? pm_ticks + pm_stopwatch.ticks : 0;
+    //Stopwatch::ticks() is tear-free, and pm_ticks is only changed by update()
+    return m_instates.held ? pm_ticks + pm_stopwatch.ticks() : 0;
 }
 
 template <typename Stopwatch_t, typename tick_t /*= typename Stopwatch_tick<Stopwatch_t>::type*/, typename in_t>
 tick_t libmodule::userio::ButtonTimer<Stopwatch_t, tick_t, in_t>::releasedTime()
 {
-    return m_instates.held ? 0 : pm_ticks + pm_stopwatch.ticks;
+    return m_instates.held ? 0 : pm_ticks + pm_stopwatch.ticks();
 }
 
 template <typename Stopwatch_t, typename tick_t /*= typename Stopwatch_tick<Stopwatch_t>::type*/, typename in_t>
@@ -283,13 +283,10 @@ void libmodule::userio::ButtonTimer<Stopwatch_t, tick_t, in_t>::update()
         pm_ticks = 0;
         pm_checked = false;
     }
-    //If stopwatch has reached its max ticks, add this total to pm_ticks
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        if(pm_stopwatch.ticks >= stopwatchMaxTicks_c) {
-            pm_ticks += pm_stopwatch.ticks;
-            pm_stopwatch = 0;
-        }
-    }
+    //If stopwatch has reached its max ticks, add this total to pm_ticks.
+    //lap() restarts the stopwatch from the tick it read, so the tick interrupt doesn't need to be disabled to not lose ticks.
+    if(pm_stopwatch.ticks() >= stopwatchMaxTicks_c)
+        pm_ticks += pm_stopwatch.lap();
 }
 
 template <typename Stopwatch_t /*= Stopwatch1k*/, typename tick_t /*= typename Chrono_tick<Stopwatch_t>::type*/, typename in_t /*= bool*/>
@@ -336,8 +333,9 @@ void libmodule::userio::RapidInput<levels_c, Stopwatch_t, tick_t>::update()
         pm_stopwatch.start();
     }
 
+    tick_t const ticks = pm_stopwatch.ticks();
     //If need to start rapid-fire for the next level
-    if(pm_stopwatch.ticks >= pm_level[pm_levelindex].timeout) {
+    if(ticks >= pm_level[pm_levelindex].timeout) {
         //Now make check for the next level
         pm_levelindex++;
         //Fire when entering level
@@ -347,11 +345,11 @@ void libmodule::userio::RapidInput<levels_c, Stopwatch_t, tick_t>::update()
     //If entered a level/in rapid fire mode
     if(pm_previousfiretime > 0) {
         //Fire if the time between now and the last fire has reached the time interval
-        pm_fire = pm_stopwatch.ticks - pm_previousfiretime >= pm_level[pm_levelindex - 1].interval;
+        pm_fire = ticks - pm_previousfiretime >= pm_level[pm_levelindex - 1].interval;
     }
 
     if(pm_fire) {
-        pm_previousfiretime = pm_stopwatch.ticks;
+        pm_previousfiretime = ticks;
     }
 }
 
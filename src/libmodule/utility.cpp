@@ -10,27 +10,344 @@
  */
 
 #include "utility.h"
+#ifdef LIBMODULE_ATOMIC_STATS
+#include "timercommon.h"
+#endif
+
+#ifdef LIBMODULE_HEAP_STATS
+#ifdef LIBMODULE_HOST
+#include <malloc.h>
+#else
+//Not declared by avr-libc's headers. The layout of a free list entry matches avr-libc's struct __freelist.
+struct avr_freelist {
+    size_t sz;
+    avr_freelist *nx;
+};
+extern "C" char *__brkval;
+extern "C" avr_freelist *__flp;
+#endif
+#endif
+
+namespace
+{
+#ifdef LIBMODULE_POOL_BLOCK_SIZES
+    constexpr size_t pool_requested_sizes[] = {LIBMODULE_POOL_BLOCK_SIZES};
+    constexpr size_t pool_counts[] = {LIBMODULE_POOL_BLOCK_COUNTS};
+    constexpr uint8_t pool_classes = sizeof pool_requested_sizes / sizeof pool_requested_sizes[0];
+    static_assert(sizeof pool_counts / sizeof pool_counts[0] == pool_classes, "LIBMODULE_POOL_BLOCK_COUNTS must have a count for each of LIBMODULE_POOL_BLOCK_SIZES");
+
+    //Checks that the sizes are ascending, from class i onwards
+    constexpr bool pool_valid(uint8_t const i = 0)
+    {
+        return i >= pool_classes || ((i == 0 || pool_requested_sizes[i] > pool_requested_sizes[i - 1]) && pool_valid(i + 1));
+    }
+    static_assert(pool_valid(), "LIBMODULE_POOL_BLOCK_SIZES must be ascending");
+
+    //Size of the blocks of class i: the requested size, rounded up so that every block can hold a FreeBlock and is aligned for any type
+    constexpr size_t pool_size(uint8_t const i)
+    {
+        return ((pool_requested_sizes[i] > sizeof(void *) ? pool_requested_sizes[i] : sizeof(void *)) + __BIGGEST_ALIGNMENT__ - 1) / __BIGGEST_ALIGNMENT__ * __BIGGEST_ALIGNMENT__;
+    }
+
+    //Total size of the blocks of the classes before class i
+    constexpr size_t pool_offset(uint8_t const i)
+    {
+        return i == 0 ? 0 : pool_offset(i - 1) + pool_size(i - 1) * pool_counts[i - 1];
+    }
+
+    //A free block holds a pointer to the next free block of its class
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    alignas(__BIGGEST_ALIGNMENT__) uint8_t pool_arena[pool_offset(pool_classes)];
+    //Blocks that have been freed. Blocks that have never been allocated are taken in order after pool_used blocks.
+    FreeBlock *pool_freelist[pool_classes];
+    size_t pool_used[pool_classes];
+
+    //Returns the class of ptr, or pool_classes if it isn't a pool block
+    uint8_t pool_class(void const *const ptr)
+    {
+        uint8_t const *const block = static_cast<uint8_t const *>(ptr);
+        if(block < pool_arena || block >= pool_arena + sizeof pool_arena)
+            return pool_classes;
+        uint8_t i = 0;
+        while(block >= pool_arena + pool_offset(i + 1))
+            i++;
+        return i;
+    }
+#endif
+
+    //Allocates a block without counting it. Must be called in an ATOMIC_BLOCK.
+    void *block_alloc(size_t const len)
+    {
+#ifdef LIBMODULE_POOL_BLOCK_SIZES
+        uint8_t *block = pool_arena;
+        for(uint8_t i = 0; i < pool_classes; block += pool_size(i) * pool_counts[i], i++) {
+            if(len > pool_size(i))
+                continue;
+            if(pool_freelist[i] != nullptr) {
+                void *const rtrn = pool_freelist[i];
+                pool_freelist[i] = pool_freelist[i]->next;
+                return rtrn;
+            }
+            if(pool_used[i] < pool_counts[i])
+                return block + pool_size(i) * pool_used[i]++;
+        }
+#endif
+        return malloc(len);
+    }
+
+    //Frees a block without counting it. Must be called in an ATOMIC_BLOCK.
+    void block_free(void *const ptr)
+    {
+#ifdef LIBMODULE_POOL_BLOCK_SIZES
+        uint8_t const i = pool_class(ptr);
+        if(i < pool_classes) {
+            FreeBlock *const freed = static_cast<FreeBlock *>(ptr);
+            freed->next = pool_freelist[i];
+            pool_freelist[i] = freed;
+            return;
+        }
+#endif
+        free(ptr);
+    }
+
+#ifdef LIBMODULE_HEAP_STATS
+    libmodule::utility::HeapStats heap_statistics;
+
+    //Usable size of an allocated block
+    size_t block_size(void const *const ptr)
+    {
+#ifdef LIBMODULE_POOL_BLOCK_SIZES
+        uint8_t const i = pool_class(ptr);
+        if(i < pool_classes)
+            return pool_size(i);
+#endif
+#ifdef LIBMODULE_HOST
+        return malloc_usable_size(const_cast<void *>(ptr));
+#else
+        //avr-libc keeps the size of a block just before it
+        return *(static_cast<size_t const *>(ptr) - 1);
+#endif
+    }
+
+    //Counts an allocation of ptr (and a failure if it is nullptr). Must be called in an ATOMIC_BLOCK.
+    void stats_alloc(void const *const ptr)
+    {
+        if(ptr == nullptr) {
+            if(heap_statistics.failures < UINT16_MAX) heap_statistics.failures++;
+            return;
+        }
+        heap_statistics.currentBytes += block_size(ptr);
+        if(heap_statistics.currentBytes > heap_statistics.peakBytes)
+            heap_statistics.peakBytes = heap_statistics.currentBytes;
+    }
+#endif
+}
+
+/** When the pools are enabled, interrupts are only disabled for a walk over the (few) pool classes, instead of over the heap's free list.
+ */
+void *libmodule::utility::pool_alloc(size_t const len)
+{
+    void *rtrn = nullptr;
+    LM_ATOMIC_BLOCK() {
+        rtrn = block_alloc(len);
+#ifdef LIBMODULE_HEAP_STATS
+        stats_alloc(rtrn);
+        if(rtrn != nullptr) heap_statistics.allocations++;
+#endif
+    }
+    return rtrn;
+}
+
+/** Pool blocks are recognised by their address, so the size of the block is not needed.
+ */
+void libmodule::utility::pool_free(void *const ptr)
+{
+    if(ptr == nullptr)
+        return;
+    LM_ATOMIC_BLOCK() {
+#ifdef LIBMODULE_HEAP_STATS
+        heap_statistics.currentBytes -= block_size(ptr);
+        heap_statistics.frees++;
+#endif
+        block_free(ptr);
+    }
+}
+
+/** Heap blocks are resized with `realloc()`. A pool block is only moved when it needs to grow past its class.
+ */
+void *libmodule::utility::pool_realloc(void *const ptr, size_t const len)
+{
+    if(ptr == nullptr)
+        return pool_alloc(len);
+    void *rtrn = nullptr;
+    LM_ATOMIC_BLOCK() {
+#ifdef LIBMODULE_HEAP_STATS
+        size_t const previous = block_size(ptr);
+#endif
+        bool pooled = false;
+#ifdef LIBMODULE_POOL_BLOCK_SIZES
+        uint8_t const i = pool_class(ptr);
+        if(i < pool_classes) {
+            pooled = true;
+            rtrn = len <= pool_size(i) ? ptr : block_alloc(len);
+            if(rtrn != nullptr && rtrn != ptr) {
+                memcpy(rtrn, ptr, pool_size(i));
+                block_free(ptr);
+            }
+        }
+#endif
+        if(!pooled)
+            rtrn = realloc(ptr, len);
+#ifdef LIBMODULE_HEAP_STATS
+        if(rtrn != nullptr) {
+            heap_statistics.currentBytes -= previous;
+            heap_statistics.reallocs++;
+        }
+        stats_alloc(rtrn);
+#endif
+    }
+    return rtrn;
+}
+
+#ifdef LIBMODULE_HEAP_STATS
+/** The largest free block is found here rather than kept up to date, so that allocating stays cheap.
+ */
+libmodule::utility::HeapStats libmodule::utility::heap_stats()
+{
+    HeapStats rtrn;
+    LM_ATOMIC_BLOCK() {
+        rtrn = heap_statistics;
+        rtrn.largestFree = 0;
+#ifdef LIBMODULE_POOL_BLOCK_SIZES
+        for(uint8_t i = 0; i < pool_classes; i++) {
+            if(pool_freelist[i] != nullptr || pool_used[i] < pool_counts[i])
+                rtrn.largestFree = pool_size(i);
+        }
+#endif
+#ifndef LIBMODULE_HOST
+        for(avr_freelist const *entry = __flp; entry != nullptr; entry = entry->nx) {
+            if(entry->sz > rtrn.largestFree) rtrn.largestFree = entry->sz;
+        }
+        //Space that the heap can still grow into (the same limit malloc() uses)
+        char const *const top = __brkval != nullptr ? __brkval : __malloc_heap_start;
+        char const *const limit = __malloc_heap_end != nullptr ? __malloc_heap_end : reinterpret_cast<char const *>(SP) - __malloc_margin;
+        //Less the size that malloc() keeps before the block
+        if(limit > top && static_cast<size_t>(limit - top) > sizeof(size_t) + rtrn.largestFree)
+            rtrn.largestFree = limit - top - sizeof(size_t);
+#endif
+    }
+    return rtrn;
+}
+
+void libmodule::utility::heap_stats_reset()
+{
+    LM_ATOMIC_BLOCK() {
+        size_t const current = heap_statistics.currentBytes;
+        heap_statistics = HeapStats{};
+        heap_statistics.currentBytes = current;
+        heap_statistics.peakBytes = current;
+    }
+}
+#endif
+
+#ifdef LIBMODULE_ATOMIC_STATS
+libmodule::utility::AtomicSite *libmodule::utility::atomic_stats_head = nullptr;
+
+namespace
+{
+    //Last site entered, where the next site entered is added
+    libmodule::utility::AtomicSite *atomic_stats_tail = nullptr;
+}
+
+/** \param [out] buf Buffer to copy the name into. Always terminated, unless \p len is 0.
+ * \param [in] len Size of \p buf.
+ */
+size_t libmodule::utility::AtomicSite::file_name(char *const buf, size_t const len) const
+{
+    if(len == 0) return 0;
+    size_t i = 0;
+    if(file != nullptr) {
+        for(; i < len - 1; i++) {
+            char const c = pgm_read_byte(file + i);
+            if(c == '\0') break;
+            buf[i] = c;
+        }
+    }
+    buf[i] = '\0';
+    return i;
+}
+
+/** \param [in] site Site to record the time in.
+ */
+libmodule::utility::AtomicSiteTimer::AtomicSiteTimer(AtomicSite &site) : pm_site(site), pm_entry(hw::timer_counter()), pm_entry_pending(hw::timer_tick_pending()) {}
+
+/** The counter is read first, so that the recording isn't counted.
+ * \n If the tick interrupt became due during the block, the counter has started again from 0 (this assumes it didn't pass two ticks).
+ * A tick that was already due when the block was entered doesn't count, since the counter had already started again by then.
+ */
+libmodule::utility::AtomicSiteTimer::~AtomicSiteTimer()
+{
+    uint16_t const exit = hw::timer_counter();
+    uint16_t const duration = (!pm_entry_pending && hw::timer_tick_pending()) || exit < pm_entry ? hw::timer_counter_period() - pm_entry + exit : exit - pm_entry;
+    //The first time the site is entered, add it to the list
+    if(pm_site.count == 0 && pm_site.next == nullptr && &pm_site != atomic_stats_tail) {
+        if(atomic_stats_tail == nullptr)
+            atomic_stats_head = &pm_site;
+        else
+            atomic_stats_tail->next = &pm_site;
+        atomic_stats_tail = &pm_site;
+    }
+    if(pm_site.count < UINT32_MAX) pm_site.count++;
+    if(duration > pm_site.worst) pm_site.worst = duration;
+    pm_site.total += duration;
+}
+
+libmodule::utility::AtomicSite libmodule::utility::atomic_stats_worst()
+{
+    AtomicSite rtrn(nullptr, 0);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for(AtomicSite const *site = atomic_stats_head; site != nullptr; site = site->next) {
+            if(rtrn.count == 0 || site->worst > rtrn.worst) rtrn = *site;
+        }
+    }
+    return rtrn;
+}
+
+/** The sites stay in the list, so they are still visited by atomic_stats_for_each() (with \c count 0).
+ */
+void libmodule::utility::atomic_stats_reset()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for(AtomicSite *site = atomic_stats_head; site != nullptr; site = site->next) {
+            site->count = 0;
+            site->worst = 0;
+            site->total = 0;
+        }
+    }
+}
+#endif
 
 /** This function is automatically called whenever `new` is called.
  *
- * Calls `malloc()` in an `ATOMIC_BLOCK`.
- * If `malloc()` fails, calls hw::panic().
+ * Calls utility::pool_alloc().
+ * If it fails, calls hw::panic().
  *
  * \param [in] len The size of the block to allocate (in bytes).
  *
- * \return Pointer to memory allocated with `malloc()`.
+ * \return Pointer to memory allocated with utility::pool_alloc().
  */
-void *operator new(unsigned int len)
+void *operator new(size_t len)
 {
-    void *rtrn;
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        rtrn = malloc(len);
-    }
+    void *const rtrn = libmodule::utility::pool_alloc(len);
     if(rtrn == nullptr) libmodule::hw::panic();
     return rtrn;
 }
 
 
+#ifndef LIBMODULE_HOST
 /** This function is automatically called whenever placement `new` is called.
  *
  * Returns the pointer with no checks.
@@ -40,32 +357,44 @@ void *operator new(unsigned int len)
  *
  * \return Returns \p ptr unchanged.
  */
-void *operator new(unsigned int len, void *ptr)
+void *operator new(size_t len, void *ptr)
 {
     return ptr;
 }
+#endif
+
+/** This function is automatically called whenever `delete` is called (when the size isn't known).
+ *
+ * Calls utility::pool_free().
+ *
+ * \param [in] ptr Pointer passed to utility::pool_free().
+ */
+void operator delete(void *ptr)
+{
+    libmodule::utility::pool_free(ptr);
+}
 
 /** This function is automatically called whenever `delete` is called.
  *
- * Calls \c free() in an \c ATOMIC_BLOCK.
+ * Calls utility::pool_free().
  *
- * \param [in] ptr Pointer passed to free.
+ * \param [in] ptr Pointer passed to utility::pool_free().
  * \param [in] len Size of the allocated block (in bytes). Unused.
  */
-void operator delete(void *ptr, unsigned int len)
+void operator delete(void *ptr, size_t len)
 {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        free(ptr);
-    }
+    libmodule::utility::pool_free(ptr);
 }
 
 
+#ifndef LIBMODULE_HOST
 /** This function is called when a pure virtual function with no implementation is called.
  */
 void __cxa_pure_virtual()
 {
     libmodule::hw::panic();
 }
+#endif
 
 //toggle() is documented in utility.h
 void libmodule::utility::Output<bool>::toggle() {}
@@ -96,9 +425,7 @@ void libmodule::utility::Buffer::bit_set(size_t const pos, uint8_t const sig, bo
  */
 void libmodule::utility::Buffer::bit_set_mask(size_t const pos, uint8_t const mask)
 {
-    uint8_t val = pm_ptr[pos] | mask;
-    if(val != pm_ptr[pos])
-        write(static_cast<void const *>(&val), sizeof(uint8_t), pos);
+    bit_update(pos, 0, mask);
 }
 
 /** Equivalent to #bit_set(\p pos, \p sig, \c false).
@@ -119,7 +446,22 @@ void libmodule::utility::Buffer::bit_clear(size_t const pos, uint8_t const sig)
  */
 void libmodule::utility::Buffer::bit_clear_mask(size_t const pos, uint8_t const mask)
 {
-    uint8_t val = pm_ptr[pos] & ~mask;
+    bit_update(pos, mask, 0);
+}
+
+/** The byte written is the byte at \p pos with the bits in \p clear_mask cleared, then the bits in \p set_mask set.
+ * \n As only the final value is written, the byte never holds the value between the clear and the set (e.g. when replacing a multi-bit field), and at most one write callback is generated.
+ * \n Internally [write] is called. If there is no change, no write operation is performed so no callback is generated.
+ * \param [in] pos Position offset of byte to modify.
+ * \param [in] clear_mask Byte with bits set in positions to be cleared in target byte.
+ * \param [in] set_mask Byte with bits set in positions to be set in target byte.
+ [write]: \ref write(void const *const, size_t const, size_t const)
+ */
+void libmodule::utility::Buffer::bit_update(size_t const pos, uint8_t const clear_mask, uint8_t const set_mask)
+{
+    if(invalidTransfer(pos, sizeof(uint8_t)))
+        hw::panic();
+    uint8_t val = (pm_ptr[pos] & ~clear_mask) | set_mask;
     if(val != pm_ptr[pos])
         write(static_cast<void const *>(&val), sizeof(uint8_t), pos);
 }
@@ -148,8 +490,8 @@ void libmodule::utility::Buffer::write(void const *const buf, size_t const len)
 
 /** If an invalid transfer is specified or there is a memory transfer error, hw::panic() is called.
  * \n The write operation will not wrap around to the start if the end is reached - this is considered an invalid transfer.
- * \n \a #pm_pos is set to the position past the last byte of the write operation.
- * \n If \a #m_callbacks is not \c nullptr, Callbacks::buffer_writeCallback is called.
+ * \n \a #pm_pos is set to the position past the last byte of the write operation, and the bytes written are marked with mark_dirty().
+ * \n If \a #m_callbacks is not \c nullptr, Callbacks::buffer_writeCallback is called (or deferred until commit(), if in a transaction).
  * \param [in] buf Pointer to the source memory for the write.
  * \param [in] len Number of bytes to write.
  * \param [in] pos The position offset from \a #pm_ptr for the write.
@@ -158,11 +500,12 @@ void libmodule::utility::Buffer::write(void const *const buf, size_t const len)
 void libmodule::utility::Buffer::write(void const *const buf, size_t const len, size_t const pos)
 {
     //Presently this will not wrap around to the start and write remaining data if the end is reached
-    if(invalidTransfer(pos, len) || !memcpy(pm_ptr + pos, buf, len))
+    if(invalidTransfer(pos, len))
         hw::panic();
-    pm_pos = pos + len;
-    if(m_callbacks != nullptr)
-        m_callbacks->buffer_writeCallback(buf, len, pos);
+    begin_write();
+    memcpy(pm_ptr + pos, buf, len);
+    end_write(pos, len);
+    write_callback(buf, len, pos);
 }
 
 /** Equivalent to [read](\ref read(void *const, size_t const))(\p buf, \p len, \a #pm_pos).
@@ -199,10 +542,212 @@ void libmodule::utility::Buffer::read(void *const buf, size_t const len, size_t
 {
     if(invalidTransfer(pos, len) || !memcpy(buf, pm_ptr + pos, len))
         hw::panic();
+    read_callback(buf, len, pos);
+}
+
+/** This member function is enclosed in an `ATOMIC_BLOCK`, as a buffer may be written from both an ISR and the main loop.
+ * \n The modified range is kept as one range covering all modified bytes, so marking is constant time and size.
+ * \n The sequence counter is also changed, so readers using snapshot() or get_snapshot() can tell that the bytes changed.
+ * \n If \a #m_parent is not \c nullptr, the bytes are also marked in \a #m_parent.
+ * \param [in] pos Position of the first byte modified.
+ * \param [in] len Number of bytes modified.
+ */
+void libmodule::utility::Buffer::mark_dirty(size_t const pos, size_t const len)
+{
+    LM_ATOMIC_BLOCK() {
+        mark_dirty_locked(pos, len);
+    }
+}
+
+/** This member function is enclosed in an `ATOMIC_BLOCK`.
+ */
+void libmodule::utility::Buffer::clear_dirty()
+{
+    LM_ATOMIC_BLOCK() {
+        pm_dirty_begin = SIZE_MAX;
+        pm_dirty_end = 0;
+    }
+}
+
+bool libmodule::utility::Buffer::dirty() const
+{
+    return pm_dirty_begin < dirty_end();
+}
+
+size_t libmodule::utility::Buffer::dirty_begin() const
+{
+    return pm_dirty_begin;
+}
+
+size_t libmodule::utility::Buffer::dirty_end() const
+{
+    return tmin(pm_dirty_end, pm_len);
+}
+
+/** While in a transaction, write callbacks are not called after each write. Instead, writes that overlap or are next to each other are joined into one range,
+ * and Callbacks::buffer_writeCallback is called once per range: when a write doesn't join the current range, and by the outermost commit().
+ * \n A deferred callback is given the data in the buffer (at \a #pm_ptr + \p pos), rather than the source of each write.
+ * \n Bytes are still marked with mark_dirty() as they are written. SlaveBufferManager doesn't copy them to the TWI send buffer until the transaction is committed, so the master doesn't read a partly updated set of registers.
+ */
+void libmodule::utility::Buffer::begin_transaction()
+{
+    if(pm_transaction == UINT8_MAX) hw::panic();
+    pm_transaction++;
+    begin_write();
+}
+
+/** If this isn't the outermost transaction, only the depth is decreased. Calling commit() without begin_transaction() calls hw::panic().
+ */
+void libmodule::utility::Buffer::commit()
+{
+    if(pm_transaction == 0) hw::panic();
+    end_write();
+    if(--pm_transaction == 0)
+        flush_callback();
+}
+
+bool libmodule::utility::Buffer::in_transaction() const
+{
+    return pm_transaction > 0;
+}
+
+/** This is the reader side of a sequence lock, for use from an ISR (e.g. SlaveBufferManager::received()).
+ * \n If the ISR interrupted a write or transaction in the main loop, the buffer may be half written. Waiting would never finish (the main loop can't run until the ISR returns),
+ * so \c false is returned instead, and the caller should use data it copied earlier.
+ * \n Otherwise, the copy is repeated if the buffer was written during it (e.g. by a higher priority ISR).
+ * \n Bounds are checked as in read(), but Callbacks::buffer_readCallback is not called.
+ * \param [out] buf Pointer to the destination memory for the copy.
+ * \param [in] len Number of bytes to copy.
+ * \param [in] pos The position offset from \a #pm_ptr for the copy.
+ * \return Whether \p buf holds a consistent copy.
+ */
+bool libmodule::utility::Buffer::snapshot(void *const buf, size_t const len, size_t const pos) const
+{
+    if(invalidTransfer(pos, len))
+        hw::panic();
+    uint8_t sequence;
+    do {
+        sequence = pm_sequence;
+        if(sequence & 1)
+            return false;
+        //Keep the copy between the two reads of pm_sequence
+        __asm__ __volatile__("" ::: "memory");
+        memcpy(buf, pm_ptr + pos, len);
+        __asm__ __volatile__("" ::: "memory");
+    } while(sequence != pm_sequence);
+    return true;
+}
+
+bool libmodule::utility::Buffer::write_in_progress() const
+{
+    return pm_sequence & 1;
+}
+
+uint8_t libmodule::utility::Buffer::sequence() const
+{
+    return pm_sequence;
+}
+
+/** Writes that are interrupted by writes from an ISR are nested, and only the outermost makes the sequence counter odd.
+ * \n The parents are walked in the same critical section.
+ */
+void libmodule::utility::Buffer::begin_write()
+{
+    LM_ATOMIC_BLOCK() {
+        for(Buffer *buffer = this; buffer != nullptr; buffer = buffer->m_parent) {
+            if(buffer->pm_writing++ == 0)
+                buffer->pm_sequence++;
+        }
+    }
+}
+
+/** The bytes are marked and the write is ended in one critical section (including in the parents).
+ * \n The outermost write makes the sequence counter even again. A nested write (e.g. from an ISR during a transaction) moves it on by 2, so that it still changes.
+ */
+void libmodule::utility::Buffer::end_write(size_t const pos /*= 0*/, size_t const len /*= 0*/)
+{
+    uint8_t const *const first = pm_ptr + pos;
+    LM_ATOMIC_BLOCK() {
+        for(Buffer *buffer = this; buffer != nullptr; buffer = buffer->m_parent) {
+            if(len > 0)
+                buffer->extend_dirty(first - buffer->pm_ptr, len);
+            buffer->pm_sequence += --buffer->pm_writing == 0 ? 1 : 2;
+        }
+    }
+}
+
+/** Must be called with interrupts disabled. The sequence counter is moved on by 2, so that whether a write is in progress is kept.
+ */
+void libmodule::utility::Buffer::mark_dirty_locked(size_t const pos, size_t const len)
+{
+    uint8_t const *const first = pm_ptr + pos;
+    for(Buffer *buffer = this; buffer != nullptr; buffer = buffer->m_parent) {
+        buffer->extend_dirty(first - buffer->pm_ptr, len);
+        buffer->pm_sequence += 2;
+    }
+}
+
+void libmodule::utility::Buffer::extend_dirty(size_t const pos, size_t const len)
+{
+    if(pos < pm_dirty_begin) pm_dirty_begin = pos;
+    if(pos + len > pm_dirty_end) pm_dirty_end = pos + len;
+}
+
+void libmodule::utility::Buffer::write_callback(void const *const buf, size_t const len, size_t const pos)
+{
+    pm_pos = pos + len;
+    if(m_callbacks != nullptr) {
+        if(pm_transaction > 0)
+            defer_callback(pos, len);
+        else
+            m_callbacks->buffer_writeCallback(buf, len, pos);
+    }
+}
+
+void libmodule::utility::Buffer::read_callback(void *const buf, size_t const len, size_t const pos) const
+{
     if(m_callbacks != nullptr)
         m_callbacks->buffer_readCallback(buf, len, pos);
 }
 
+void libmodule::utility::Buffer::defer_callback(size_t const pos, size_t const len)
+{
+    //A write that doesn't touch the deferred range can't be joined to it
+    if(pm_callback_begin < pm_callback_end && (pos > pm_callback_end || pos + len < pm_callback_begin))
+        flush_callback();
+    if(pm_callback_begin < pm_callback_end) {
+        pm_callback_begin = tmin(pm_callback_begin, pos);
+        pm_callback_end = tmax(pm_callback_end, pos + len);
+    }
+    else {
+        pm_callback_begin = pos;
+        pm_callback_end = pos + len;
+    }
+}
+
+void libmodule::utility::Buffer::flush_callback()
+{
+    if(pm_callback_begin >= pm_callback_end)
+        return;
+    size_t const pos = pm_callback_begin;
+    size_t const len = pm_callback_end - pm_callback_begin;
+    pm_callback_begin = pm_callback_end = 0;
+    if(m_callbacks != nullptr)
+        m_callbacks->buffer_writeCallback(pm_ptr + pos, len, pos);
+}
+
+/** \param [in] buffer Buffer to begin the transaction on.
+ */
+libmodule::utility::Buffer::Transaction::Transaction(Buffer &buffer) : pm_buffer(buffer)
+{
+    pm_buffer.begin_transaction();
+}
+
+libmodule::utility::Buffer::Transaction::~Transaction()
+{
+    pm_buffer.commit();
+}
+
 /** \param [in] ptr \a #pm_ptr initialiser.
  * \param [in] len \a #pm_len initialiser.
  */
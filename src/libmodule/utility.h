@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 #include <util/atomic.h>
 
 /** \defgroup cppfunctions C++ Required Functions
@@ -22,22 +23,60 @@
  * See [here](https://en.cppreference.com/w/cpp/memory/new/operator_new#Global_replacements) for more information.
  * \n `avr-gcc` also has no C++ standard library, so `<new>`, where these functions are usually defined, does not exist and therefore cannot be included.
  * This means they must be implemented manually.
+ * \n When building for the host (\c LIBMODULE_HOST), `<new>` is used instead. libmodule still replaces `operator new` and `operator delete`, but the placement form and `__cxa_pure_virtual` come from the host C++ library.
  * @{
  */
 
+#ifdef LIBMODULE_HOST
+#include <new>
+#include <atomic>
+#else
 ///[atomic] C++ `new` implementation.
-void *operator new(unsigned int len);
+void *operator new(size_t len);
 ///C++ placement `new` implementation.
-void *operator new(unsigned int len, void *ptr);
+void *operator new(size_t len, void *ptr);
 ///[atomic] C++ `delete` implementation.
-void operator delete(void *ptr, unsigned int len);
+void operator delete(void *ptr);
+///[atomic] C++ sized `delete` implementation.
+void operator delete(void *ptr, size_t len);
 extern "C" {
 ///GCC pure `virtual` function implementation.
     void __cxa_pure_virtual();
 }
+#endif
 
 /**@}*/
 
+/** \brief Whether element access is bounds checked.
+ *
+ * When \c 1, Vector::operator[] and StaticVector::operator[] call hw::panic() if the position is out of range, and the `Unchecked` Buffer functions check the transfer before doing it.
+ * \n Defaults to \c 1, unless \c NDEBUG is defined. Define it as \c 0 or \c 1 to override this.
+ * \n Buffer::read() and Buffer::write() are always checked, as their positions may come from the master.
+ */
+#ifndef LIBMODULE_BOUNDS_CHECK
+#ifdef NDEBUG
+#define LIBMODULE_BOUNDS_CHECK 0
+#else
+#define LIBMODULE_BOUNDS_CHECK 1
+#endif
+#endif
+
+/** \brief Starts a critical section. Use in place of `ATOMIC_BLOCK(ATOMIC_RESTORESTATE)`.
+ *
+ * If \c LIBMODULE_ATOMIC_STATS is defined, the time spent in the block (with interrupts disabled) is recorded for each place it is used, in a utility::AtomicSite.
+ * Otherwise it is exactly `ATOMIC_BLOCK(ATOMIC_RESTORESTATE)`.
+ * \n Like `ATOMIC_BLOCK`, leaving the block by any means (including return/break) restores the previous state.
+ * \sa utility::atomic_stats_for_each()
+ */
+#ifdef LIBMODULE_ATOMIC_STATS
+#define LM_ATOMIC_BLOCK() ATOMIC_BLOCK(ATOMIC_RESTORESTATE) \
+    for(::libmodule::utility::AtomicSiteTimer lm_atomic_timer_([]() -> ::libmodule::utility::AtomicSite & { \
+                static char const file[] PROGMEM = __FILE__; static ::libmodule::utility::AtomicSite site(file, __LINE__); return site; }()), *lm_atomic_timer_once_ = &lm_atomic_timer_; \
+        lm_atomic_timer_once_ != nullptr; lm_atomic_timer_once_ = nullptr)
+#else
+#define LM_ATOMIC_BLOCK() ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#endif
+
 //This one is useful enough to have in the global namespace
 /**
  * \brief Casts a typed \c enum to an \c int.
@@ -180,6 +219,201 @@ namespace libmodule
             return (p >= min) && (p <= max);
         }
 
+        ///Removes a reference from \c T (as [`std::remove_reference`](https://en.cppreference.com/w/cpp/types/remove_reference) does).
+        template <typename T>
+        struct remove_reference {
+            using type = T;
+        };
+        template <typename T>
+        struct remove_reference<T &> {
+            using type = T;
+        };
+        template <typename T>
+        struct remove_reference<T &&> {
+            using type = T;
+        };
+        ///Casts \p p to an rvalue reference, so that it can be moved from (as [`std::move`](https://en.cppreference.com/w/cpp/utility/move) does).
+        template <typename T>
+        constexpr typename remove_reference<T>::type &&move(T &&p)
+        {
+            return static_cast<typename remove_reference<T>::type &&>(p);
+        }
+        ///Passes on \p p as the value category it was given as (as [`std::forward`](https://en.cppreference.com/w/cpp/utility/forward) does).
+        template <typename T>
+        constexpr T &&forward(typename remove_reference<T>::type &p)
+        {
+            return static_cast<T &&>(p);
+        }
+        ///\copydoc forward(typename remove_reference<T>::type &)
+        template <typename T>
+        constexpr T &&forward(typename remove_reference<T>::type &&p)
+        {
+            return static_cast<T &&>(p);
+        }
+        /** \brief Whether objects of type \c T can be copied (and therefore moved in memory) with `memcpy()`.
+         *
+         * Uses the compiler builtin that [`std::is_trivially_copyable`](https://en.cppreference.com/w/cpp/types/is_trivially_copyable) is implemented with.
+         */
+        template <typename T>
+        struct is_trivially_copyable {
+            static constexpr bool value = __is_trivially_copyable(T);
+        };
+
+        /** \brief Moves \p len objects from \p src to \p dst, where the ranges may overlap (like `memmove()`, but for objects).
+         *
+         * If \c T is trivially copyable, `memmove()` is used. Otherwise each object is move constructed at \p dst, and then destructed at \p src (in an order that is safe for the overlap).
+         * \n Afterwards \p dst holds the objects, and the part of \p src outside of \p dst holds no constructed objects.
+         * \tparam T [implicit] Type of objects.
+         * \param [in] dst Destination. Must not hold constructed objects, except where it overlaps \p src.
+         * \param [in] src Objects to move.
+         * \param [in] len Number of objects.
+         */
+        template <typename T>
+        void relocate(T *const dst, T *const src, size_t const len);
+
+        /** \brief Variable shared between an ISR and the main loop, that is never read or written half way through a change.
+         *
+         * On the AVR, a variable wider than a byte takes several instructions to read, so an ISR could change it part way through a read.
+         * \n load() doesn't disable interrupts. It reads until two reads agree, which can only happen once no write happened in between (a torn read can't match the read after it).
+         * \n store(), exchange() and the \c fetch_ functions are written in an `ATOMIC_BLOCK`, so that an ISR can't read a half written value. For a single byte, store() is a plain write.
+         * \n When building for the host (\c LIBMODULE_HOST), it is a [`std::atomic`](https://en.cppreference.com/w/cpp/atomic/atomic) (as the daemons run in other threads).
+         * \tparam T Integer (or other trivially copyable) type.
+         * \author Teddy.Hut
+         */
+        template <typename T>
+        class Atomic
+        {
+            static_assert(is_trivially_copyable<T>::value, "Atomic type must be trivially copyable");
+        public:
+            ///Returns the value.
+            T load() const;
+            ///Sets the value to \p value.
+            void store(T const value);
+            ///Sets the value to \p value, and returns the previous value.
+            T exchange(T const value);
+            ///Adds \p value, and returns the previous value.
+            T fetch_add(T const value);
+            ///Subtracts \p value, and returns the previous value.
+            T fetch_sub(T const value);
+
+            ///Equivalent to load().
+            operator T() const;
+            ///Equivalent to store(\p value).
+            Atomic &operator=(T const value);
+
+            ///Constructor. \c constexpr, so a static Atomic is initialised before any code runs.
+            constexpr Atomic(T const value = T()) : pm_value(value) {}
+            Atomic(Atomic const &) = delete;
+            Atomic &operator=(Atomic const &) = delete;
+        private:
+#ifdef LIBMODULE_HOST
+            std::atomic<T> pm_value;
+#else
+            T volatile pm_value;
+#endif
+        };
+
+        /** \brief [atomic] Allocates a block of memory of at least \p len bytes.
+         *
+         * If \c LIBMODULE_POOL_BLOCK_SIZES is defined, blocks are taken from fixed-size pools, so allocation and freeing are O(1) and do not fragment the heap.
+         * \n The pools are configured with two comma separated lists of the same length, for example:
+         * \n `-DLIBMODULE_POOL_BLOCK_SIZES=8,16,32 -DLIBMODULE_POOL_BLOCK_COUNTS=8,8,4`
+         * \n Sizes must be in ascending order. Each is rounded up to at least `sizeof(void *)` and to a multiple of the largest alignment (1 on AVR, 16 on most hosts),
+         * so on a host the example above has pools of 16, 16 and 32 bytes.
+         * \n A request is served from the smallest pool it fits with a free block. Requests larger than every pool (or when those pools are full) fall back to `malloc()`.
+         * \n Without \c LIBMODULE_POOL_BLOCK_SIZES, this is `malloc()` in an `ATOMIC_BLOCK`.
+         * \param [in] len Size of the block (in bytes).
+         * \return Pointer to the block, or \c nullptr if there is no memory left.
+         */
+        void *pool_alloc(size_t const len);
+        /** \brief [atomic] Frees a block allocated with pool_alloc().
+         * \param [in] ptr Pointer returned by pool_alloc() or pool_realloc(), or \c nullptr (which does nothing).
+         */
+        void pool_free(void *const ptr);
+        /** \brief [atomic] Resizes a block allocated with pool_alloc(), like `realloc()`.
+         *
+         * A pool block that is still big enough is returned unchanged. Otherwise the contents are moved to a new block.
+         * \param [in] ptr Pointer returned by pool_alloc() or pool_realloc(), or \c nullptr (equivalent to pool_alloc()).
+         * \param [in] len New size of the block (in bytes).
+         * \return Pointer to the block, or \c nullptr if there is no memory left (\p ptr is then still valid).
+         */
+        void *pool_realloc(void *const ptr, size_t const len);
+
+#ifdef LIBMODULE_HEAP_STATS
+        /** \brief Heap usage counters, kept by pool_alloc(), pool_free() and pool_realloc() when \c LIBMODULE_HEAP_STATS is defined.
+         *
+         * Since `new`, `delete`, Vector and memsizematch() all allocate through these, this covers all of libmodule's allocations.
+         * \n Bytes are counted in whole blocks (e.g. the size of the pool block a request was rounded up to).
+         */
+        struct HeapStats {
+            size_t currentBytes; ///< Bytes currently allocated.
+            size_t peakBytes; ///< Highest value of \a #currentBytes.
+            uint32_t allocations; ///< Successful pool_alloc() calls.
+            uint32_t frees; ///< pool_free() calls (of non-\c nullptr pointers).
+            uint32_t reallocs; ///< Successful pool_realloc() calls.
+            uint16_t failures; ///< Requests that could not be allocated.
+            /** \brief Largest block that could currently be allocated.
+             *
+             * Found when heap_stats() is called, from the pools, avr-libc's free list and the space between the heap and the stack.
+             * \n When built for the host, only the pools are included.
+             */
+            size_t largestFree;
+        };
+        ///[atomic] Returns the current heap statistics.
+        HeapStats heap_stats();
+        ///[atomic] Clears the counters, and sets the peak to the current usage.
+        void heap_stats_reset();
+#endif
+
+#ifdef LIBMODULE_ATOMIC_STATS
+        /** \brief Time spent with interrupts disabled by one LM_ATOMIC_BLOCK, recorded when \c LIBMODULE_ATOMIC_STATS is defined.
+         *
+         * Times are in counts of hw::timer_counter() (with an AVR timer that has no prescaler, these are CPU cycles). A block that is longer than a tick is counted as less than a tick longer.
+         * \n A block inside an ISR or another block is recorded too, and its time is also part of the enclosing one.
+         * \n Each site is static, and is added to the list read by atomic_stats_for_each() the first time its block is entered. A block in a template has a site for each instantiation.
+         */
+        struct AtomicSite {
+            char const *file; ///< `__FILE__` of the block, in program memory so that it takes no RAM. Read it with file_name().
+            uint16_t line; ///< `__LINE__` of the block.
+            uint32_t count; ///< Times the block has been entered.
+            uint16_t worst; ///< Longest time in the block.
+            uint32_t total; ///< Total time in the block.
+            AtomicSite *next; ///< Next site entered (\c nullptr for the last).
+
+            ///Constructor. \c constexpr, so that each site is initialised before any code runs.
+            constexpr AtomicSite(char const *const file, uint16_t const line) : file(file), line(line), count(0), worst(0), total(0), next(nullptr) {}
+            ///Copies #file from program memory into \p buf, truncated to \p len - 1 characters. Returns the characters copied.
+            size_t file_name(char *const buf, size_t const len) const;
+        };
+
+        /** \brief Records the time from its construction to its destruction in an AtomicSite. Used by LM_ATOMIC_BLOCK.
+         */
+        class AtomicSiteTimer
+        {
+        public:
+            ///Must be constructed with interrupts disabled.
+            AtomicSiteTimer(AtomicSite &site);
+            ///Records the time in the site. Must be destructed with interrupts disabled.
+            ~AtomicSiteTimer();
+            AtomicSiteTimer(AtomicSiteTimer const &) = delete;
+            AtomicSiteTimer &operator=(AtomicSiteTimer const &) = delete;
+        private:
+            AtomicSite &pm_site;
+            uint16_t pm_entry;
+            bool pm_entry_pending;
+        };
+
+        ///Calls \p func with a copy of each AtomicSite that has been entered, in the order they were first entered. Each copy is taken with interrupts disabled.
+        template <typename func_t>
+        void atomic_stats_for_each(func_t func);
+        ///[atomic] Returns a copy of the site with the longest time (with \c count 0 if none have been entered).
+        AtomicSite atomic_stats_worst();
+        ///[atomic] Clears the counters of every site.
+        void atomic_stats_reset();
+        //First site entered, for atomic_stats_for_each(). Only changed with interrupts disabled.
+        extern AtomicSite *atomic_stats_head;
+#endif
+
         /** \brief Ensures `mem` points to a memory block of size `matchlen`.
          *
          * If \p mem is \c nullptr, a new block is allocated.
@@ -189,7 +423,7 @@ namespace libmodule
          * \warning This function will not preserve the contents of the previous memory block.
          * \tparam len_t [implicit] Type of length parameters.
          * \tparam data_t [implicit] Type of data.
-         * \param [in] mem Pointer to \c nullptr or a block of memory allocated using `malloc()`.
+         * \param [in] mem Pointer to \c nullptr or a block of memory allocated using memsizematch() or pool_alloc().
          * \param [in] currentlen The size of the block of memory \p mem points to (in bytes).
          * \param [in] matchlen The size of the block to match (in bytes).
          * \return Pointer to a memory block with size \p matchlen.
@@ -199,9 +433,8 @@ namespace libmodule
         data_t *memsizematch(data_t *mem, len_t const currentlen, len_t const matchlen)
         {
             if(mem == nullptr || currentlen != matchlen) {
-                if(mem != nullptr)
-                    free(static_cast<void *>(mem));
-                mem = static_cast<data_t *>(malloc(matchlen));
+                pool_free(static_cast<void *>(mem));
+                mem = static_cast<data_t *>(pool_alloc(matchlen));
                 if(mem == nullptr) hw::panic();
             }
             return mem;
@@ -251,7 +484,10 @@ namespace libmodule
         /** \brief Dynamic element container.
          *
          * Vector is in some ways similar to [`std::vector`](https://en.cppreference.com/w/cpp/container/vector) but much more basic.
-         * \n Memory is allocated using `malloc()`, and is stored in a continuous memory block. `realloc()` is used to change size.
+         * \n Memory is allocated using pool_alloc(), and is stored in a continuous memory block. pool_realloc() is used to change size.
+         * \n Space is kept for more elements than are stored (the capacity). When an insertion needs more space, the capacity grows by half, so adding elements one at a time only reallocates occasionally.
+         * Removing elements does not release memory. Use shrink_to_fit() to do that.
+         * \n Elements are moved with relocate(): as a block of memory if \c T is trivially copyable, otherwise with `T`'s move constructor and destructor.
          * \todo Add copy/move assignment operators.
          * \tparam T Type to store.
          * \tparam count_t Integer type used for indexing.
@@ -265,9 +501,20 @@ namespace libmodule
             T *data = nullptr;
             ///Number of elements stored.
             count_t count = 0;
+            ///Number of elements there is memory for.
+            count_t reserved = 0;
         public:
             ///[atomic] Adds an element to the end.
             void push_back(T const &p);
+            ///[atomic] Adds an element to the end, moving from \p p.
+            void push_back(T &&p);
+            ///[atomic] Adds an element to the end, constructed from \p args.
+            template <typename ...args_t>
+            void emplace_back(args_t &&...args);
+            ///[atomic] Replaces the elements with copies of the \p len elements at \p src.
+            void assign(T const *const src, count_t const len);
+            ///[atomic] Adds copies of the \p len elements at \p src to the end.
+            void append(T const *const src, count_t const len);
             ///[atomic] Inserts an element at \p pos.
             void insert(T const &p, count_t const pos);
             ///Remove all elements matching \p p.
@@ -276,38 +523,194 @@ namespace libmodule
             void remove_pos(count_t const pos);
             ///Resizes the memory block to fit \p size elements.
             void resize(count_t const size);
+            ///[atomic] Makes space for at least \p size elements.
+            void reserve(count_t const size);
+            ///[atomic] Frees the space that is not being used by elements.
+            void shrink_to_fit();
 
             ///Returns the number of stored elements.
             count_t size() const;
+            ///Returns the number of elements there is space for.
+            count_t capacity() const;
 
             ///Element access operator.
             T &operator[](count_t const pos);
             ///\copydoc operator[](count_t const)
             T const &operator[](count_t const pos) const;
 
+            ///Returns a pointer to the first element. Elements are contiguous, so this can be used to iterate without bounds checks.
+            T *begin();
+            ///\copydoc begin()
+            T const *begin() const;
+            ///Returns a pointer past the last element.
+            T *end();
+            ///\copydoc end()
+            T const *end() const;
+
             ///[atomic] Copy constructor.
             Vector(Vector const &p);
             ///Move constructor.
             Vector(Vector &&p);
             ///[atomic] Constructs with space for \p size elements.
             Vector(count_t const size = 0);
-            ///[atomic] Destructor. `free()`s memory.
+            ///[atomic] Destructor. Frees memory with pool_free().
             virtual ~Vector();
+        private:
+            //Makes space for at least size elements, growing the capacity by half if it needs to grow. Must be called in an ATOMIC_BLOCK.
+            void grow(size_t const size);
+            //Changes the capacity to exactly size elements. Must be called in an ATOMIC_BLOCK.
+            void reallocate(count_t const size);
+            //Makes space for an element at pos, and returns a pointer to it (not constructed). Must be called in an ATOMIC_BLOCK.
+            T *insert_space(count_t const pos);
+        };
+
+        /** \brief Element container with a fixed capacity, stored inline.
+         *
+         * StaticVector has the same interface as Vector, but space for \p capacity_c elements is part of the object, so it never allocates.
+         * Its RAM usage is therefore known at link time, and as no reallocation is needed, modifying it is not atomic (unlike Vector).
+         * \n Adding an element when it is full calls hw::panic().
+         * \n The default constructor is `constexpr`, so a static StaticVector is ready before any other static object is constructed.
+         * \tparam T Type to store.
+         * \tparam capacity_c Maximum number of elements.
+         * \tparam count_t Integer type used for indexing.
+         * \author Teddy.Hut
+         */
+        template <typename T, size_t capacity_c, typename count_t = uint8_t>
+        class StaticVector
+        {
+            static_assert(capacity_c > 0 && capacity_c <= static_cast<count_t>(~static_cast<count_t>(0)), "StaticVector capacity must fit in count_t");
+        protected:
+            ///Number of elements stored.
+            count_t count = 0;
+            //Only the first count elements of pm_items are constructed
+            union {
+                uint8_t pm_empty;
+                T pm_items[capacity_c];
+            };
+        public:
+            ///Adds an element to the end.
+            void push_back(T const &p);
+            ///Adds an element to the end, moving from \p p.
+            void push_back(T &&p);
+            ///Adds an element to the end, constructed from \p args.
+            template <typename ...args_t>
+            void emplace_back(args_t &&...args);
+            ///Inserts an element at \p pos.
+            void insert(T const &p, count_t const pos);
+            ///Remove all elements matching \p p.
+            void remove(T const &p);
+            ///Removes the element at \p pos.
+            void remove_pos(count_t const pos);
+            ///Changes the number of elements to \p size.
+            void resize(count_t const size);
+
+            ///Returns the number of stored elements.
+            count_t size() const;
+            ///Returns the number of elements there is space for (\p capacity_c).
+            static constexpr count_t capacity();
+
+            ///Element access operator.
+            T &operator[](count_t const pos);
+            ///\copydoc operator[](count_t const)
+            T const &operator[](count_t const pos) const;
+
+            ///Returns a pointer to the first element. Elements are contiguous, so this can be used to iterate without bounds checks.
+            T *begin();
+            ///\copydoc begin()
+            T const *begin() const;
+            ///Returns a pointer past the last element.
+            T *end();
+            ///\copydoc end()
+            T const *end() const;
+
+            ///Copy constructor.
+            StaticVector(StaticVector const &p);
+            ///Constructor. Empty.
+            constexpr StaticVector() : pm_empty(0) {}
+            ///Constructs with \p size default constructed elements.
+            explicit StaticVector(count_t const size);
+            ///Destructor. Destructs the elements.
+            ~StaticVector();
+        private:
+            //Makes space for an element at pos, and returns a pointer to it (not constructed)
+            T *insert_space(count_t const pos);
+        };
+
+        /** \brief Ring queue for passing elements from one context to another (e.g. from an ISR to the main loop), without disabling interrupts.
+         *
+         * There must be one producer (which calls push()) and one consumer (which calls pop()), each of which may be an ISR or the main loop.
+         * The producer only writes the head index and the consumer only writes the tail index. As the indices are single bytes, reading and writing them is atomic on AVR, so no locking is needed.
+         * \n Pushing when the queue is full drops the element, and counts it in overflows().
+         * \n Elements are copied in and out, so \p T must be trivially copyable.
+         * #### Example Use Case
+         * ~~~{.cpp}
+         SpscQueue<uint32_t, 8> periods;
+         ISR(INT0_vect) { periods.push(CaptureStopwatch::now()); }
+         //Main loop
+         uint32_t period;
+         while(periods.pop(period)) { ... }
+         * ~~~
+         * \tparam T Type to store.
+         * \tparam capacity_c Maximum number of elements. Must be a power of two, and at most 128.
+         * \author Teddy.Hut
+         */
+        template <typename T, uint8_t capacity_c>
+        class SpscQueue
+        {
+            static_assert(capacity_c > 0 && capacity_c <= 128 && (capacity_c & (capacity_c - 1)) == 0, "SpscQueue capacity must be a power of two, and at most 128");
+            static_assert(is_trivially_copyable<T>::value, "SpscQueue elements must be trivially copyable");
+        public:
+            ///[producer] Adds \p item to the back. Returns \c false (and counts an overflow) if the queue is full.
+            bool push(T const &item);
+            ///[producer] Adds up to \p len elements from \p items to the back. Returns the number added; the rest are counted as overflows.
+            uint8_t push(T const items[], uint8_t const len);
+            ///[consumer] Removes the front element into \p item. Returns \c false if the queue is empty.
+            bool pop(T &item);
+            ///[consumer] Removes up to \p len elements into \p items. Returns the number removed.
+            uint8_t pop(T items[], uint8_t const len);
+            ///[consumer] Removes all elements.
+            void clear();
+
+            ///Returns the number of elements in the queue.
+            uint8_t size() const;
+            ///Returns whether the queue is empty.
+            bool empty() const;
+            ///Returns whether the queue is full.
+            bool full() const;
+            ///Returns the number of elements there is space for (\p capacity_c).
+            static constexpr uint8_t capacity();
+            ///Returns the number of elements dropped because the queue was full (saturates at \c UINT16_MAX).
+            uint16_t overflows() const;
+        private:
+            //Free running indices (wrapping at 256). The element at an index is at index & (capacity_c - 1).
+            uint8_t pm_head = 0;
+            uint8_t pm_tail = 0;
+            uint16_t volatile pm_overflows = 0;
+            T pm_items[capacity_c];
+
+            //Counts len dropped elements (only called by the producer)
+            void add_overflows(uint8_t const len);
         };
 
         /** \brief Keeps a list that contains pointers to all instances of itself and its subclasses.
          *
-         * The instance list (\a #il_instances) is a \c static data member. Therefore, the class is a template class with type \c T so a subclass can template instantiate a unique InstanceList for itself. This allows InstanceList to keep track of instances of that unique subclass, without the need to repeat code.
+         * The instance list is \c static. Therefore, the class is a template class with type \c T so a subclass can template instantiate a unique InstanceList for itself. This allows InstanceList to keep track of instances of that unique subclass, without the need to repeat code.
          * \n Instances are added on object construction, and removed on object destruction.
+         * \n The list is intrusive (doubly linked through each instance), so adding and removing an instance doesn't allocate or search, and only disables interrupts for a few pointer updates.
          * #### Example Use Case
          * Say you wanted to keep a list of all instances of the hypothetical class \c Hugo. You could declare \c Hugo as follows:
          * ~~~{.cpp}
          class Hugo : public InstanceList<Hugo> {
          };
          * ~~~
-         * Now \c Hugo::il_instances will hold a list of all the instances.
+         * Now the instances can be visited with \c Hugo::il_for_each(), or by following il_first() and il_next().
+         * #### Iteration
+         * Instances are only added and removed in an `ATOMIC_BLOCK`, so an ISR always sees a consistent list, and may iterate it directly.
+         * \n Outside of an ISR, iterate in an `ATOMIC_BLOCK` if instances may be added or removed by an ISR.
+         * \n il_for_each() reads the next instance before visiting the current one, so the visited instance may remove itself (e.g. be destructed).
+         * Instances added while iterating may not be visited. Removing an instance other than the visited one while iterating is not allowed.
          * \tparam T Type of subclass to keep track of.
-         * \tparam count_t Integer type used for indexing.
+         * \tparam count_t Integer type used to count the instances.
          * \author Teddy.Hut
          */
         template<typename T, typename count_t = uint8_t>
@@ -316,17 +719,41 @@ namespace libmodule
         protected:
             ///Type alias to allow subclasses to access \c count_t.
             using il_count_t = count_t;
-            ///Vector that holds instance pointers.
-            static Vector<T *, count_t> il_instances;
+            ///Returns the first (oldest) instance, or \c nullptr if there are none.
+            static T *il_first();
+            ///Returns the instance added after this one, or \c nullptr if this is the last.
+            T *il_next() const;
+            ///Returns the number of instances.
+            static count_t il_size();
+            ///Calls \p func with a pointer to each instance (`T *`), from the first to the last.
+            template <typename func_t>
+            static void il_for_each(func_t func);
         public:
             ///[atomic] Constructor. Adds \c this to end of the instance list.
             InstanceList();
+            ///[atomic] Copy constructor. Adds \c this to end of the instance list (the copy is a new instance).
+            InstanceList(InstanceList const &);
+            ///Does not change the instance list.
+            InstanceList &operator=(InstanceList const &);
             ///[atomic] Destructor. Removes \c this from the instance list.
             virtual ~InstanceList();
+        private:
+            void il_insert();
+
+            InstanceList *il_prev_instance = nullptr;
+            InstanceList *il_next_instance = nullptr;
+            //Zero initialised, so the list is usable before static constructors run
+            static InstanceList *il_head;
+            static InstanceList *il_tail;
+            static count_t il_count;
         };
 
         template<typename T, typename count_t>
-        Vector<T *, count_t> InstanceList<T, count_t>::il_instances;
+        InstanceList<T, count_t> *InstanceList<T, count_t>::il_head;
+        template<typename T, typename count_t>
+        InstanceList<T, count_t> *InstanceList<T, count_t>::il_tail;
+        template<typename T, typename count_t>
+        count_t InstanceList<T, count_t>::il_count;
 
         /** \brief Utility wrapper for a user provided memory block.
          *
@@ -334,6 +761,8 @@ namespace libmodule
          * \n The current write/read position is stored and updated automatically using \a #pm_pos.
          * \n To set the data pointer and length, access the data members \a #pm_ptr and \a #pm_len directly.
          * \n Buffer does not do any dynamic memory management.
+         * \n Buffer keeps the range of bytes that have been written since clear_dirty() (starting with the whole buffer), so that a copy of it (e.g. a TWI send buffer) only needs to copy what changed.
+         * \n Buffer keeps a sequence counter that changes with every write and is odd while a write or transaction is in progress, so that a consistent copy can be read from another context without disabling interrupts (see snapshot()).
          * \n If an invalid transfer occurs (e.g. out of bounds), hw::panic() is called.
          * \todo Consider whether it is worth adding read member functions that return a reference to the object being read.
          *       That way, when modifying the returned object, the buffer is also modified.
@@ -371,6 +800,23 @@ namespace libmodule
                 virtual void buffer_readCallback(void *const buf, size_t const len, size_t const pos) = 0;
             };
 
+            /** \brief Scope guard for a Buffer transaction.
+             *
+             * Calls Buffer::begin_transaction() on construction and Buffer::commit() on destruction.
+             */
+            class Transaction
+            {
+            public:
+                ///Begins a transaction on \p buffer.
+                Transaction(Buffer &buffer);
+                ///Commits the transaction.
+                ~Transaction();
+                Transaction(Transaction const &) = delete;
+                Transaction &operator=(Transaction const &) = delete;
+            private:
+                Buffer &pm_buffer;
+            };
+
 
             ///Template stream insertion operator.
             //Doxygen required that the return value be fully qualified to associate with the detailed description below.
@@ -406,6 +852,23 @@ namespace libmodule
             template <typename T>
             void serialiseRead(T &type, size_t const pos);
 
+            ///Writes \p value to the register described by \p field_t (see module::metadata::Field).
+            template <typename field_t>
+            void set(typename field_t::type const &value);
+            ///Reads the register described by \p field_t (see module::metadata::Field).
+            template <typename field_t>
+            typename field_t::type get() const;
+            ///Reads the register described by \p field_t, retrying if it is written (e.g. by an ISR) during the read.
+            template <typename field_t>
+            typename field_t::type get_snapshot() const;
+
+            ///Serialise type given and write to the buffer at position \p pos, without callbacks or (unless \c LIBMODULE_BOUNDS_CHECK) bounds checks.
+            template <typename T>
+            void serialiseWriteUnchecked(T const &type, size_t const pos);
+            ///Read data from the buffer at \p pos into a given type, without callbacks or (unless \c LIBMODULE_BOUNDS_CHECK) bounds checks.
+            template <typename T>
+            T serialiseReadUnchecked(size_t const pos) const;
+
             ///Writes the value \p state to bit \p sig in byte \p pos.
             void bit_set(size_t const pos, uint8_t const sig, bool const state = true);
             ///Sets all bits set in \p mask at byte \p pos.
@@ -415,6 +878,8 @@ namespace libmodule
 
             ///Clears all bits set in \p mask at byte \p pos.
             void bit_clear_mask(size_t const pos, uint8_t const mask);
+            ///Clears the bits set in \p clear_mask, then sets the bits set in \p set_mask, at byte \p pos (as one write).
+            void bit_update(size_t const pos, uint8_t const clear_mask, uint8_t const set_mask);
             ///Returns bit \p sig in byte \p pos.
             bool bit_get(size_t const pos, uint8_t const sig) const;
 
@@ -429,6 +894,31 @@ namespace libmodule
             ///\copybrief read(void *const, size_t const, size_t const)
             void read(void *const buf, size_t const len, size_t const pos) const;
 
+            ///[atomic] Marks \p len bytes at \p pos as modified. Call this after writing to \a #pm_ptr directly.
+            void mark_dirty(size_t const pos, size_t const len);
+            ///[atomic] Marks all bytes as unmodified.
+            void clear_dirty();
+            ///Returns whether any bytes have been modified since clear_dirty().
+            bool dirty() const;
+            ///Returns the position of the first modified byte.
+            size_t dirty_begin() const;
+            ///Returns the position past the last modified byte (at most \a #pm_len).
+            size_t dirty_end() const;
+
+            ///Defers write callbacks until the matching commit(). Transactions may be nested.
+            void begin_transaction();
+            ///Ends a transaction started with begin_transaction(), calling the write callbacks deferred by it.
+            void commit();
+            ///Returns whether a transaction has been begun and not committed.
+            bool in_transaction() const;
+
+            ///Copies \p len bytes at \p pos into \p buf, if no write is in progress. Returns whether the copy is consistent.
+            bool snapshot(void *const buf, size_t const len, size_t const pos) const;
+            ///Returns whether a write or transaction is in progress (i.e. the current context interrupted it, or is in it).
+            bool write_in_progress() const;
+            ///Returns the sequence counter. It changes whenever the buffer is written, and is odd while a write is in progress.
+            uint8_t sequence() const;
+
             ///Constructor.
             Buffer(void *const ptr = nullptr, size_t const len = 0);
             ///Copy constructor.
@@ -447,7 +937,40 @@ namespace libmodule
             /// \details If not equal to \c nullptr, the Callbacks members will be called after any read or write operation.
             /// \sa Callbacks
             Callbacks *m_callbacks = nullptr;
+            /// \brief Buffer that this buffer is a region of.
+            /// \details If not equal to \c nullptr, bytes marked as modified are also marked in the parent (at their position in the parent).
+            Buffer *m_parent = nullptr;
+        protected:
+            //[atomic] Makes pm_sequence odd until the matching end_write() (also in m_parent)
+            void begin_write();
+            //[atomic] Marks len bytes at pos as modified (if len > 0), and ends the write started by begin_write() (also in m_parent)
+            void end_write(size_t const pos = 0, size_t const len = 0);
+            //mark_dirty(), for when interrupts are already disabled
+            void mark_dirty_locked(size_t const pos, size_t const len);
+            //Sets pm_pos past a write of len bytes at pos, and calls the write callback (or defers it, if in a transaction)
+            void write_callback(void const *const buf, size_t const len, size_t const pos);
+            //Calls the read callback
+            void read_callback(void *const buf, size_t const len, size_t const pos) const;
         private:
+            //Range of modified bytes, empty when pm_dirty_begin >= pm_dirty_end. Starts as everything.
+            size_t pm_dirty_begin = 0;
+            size_t pm_dirty_end = SIZE_MAX;
+            //Range written since the last write callback in a transaction, empty when pm_callback_begin >= pm_callback_end
+            size_t pm_callback_begin = 0;
+            size_t pm_callback_end = 0;
+            //Depth of begin_transaction() calls
+            uint8_t pm_transaction = 0;
+            //Depth of writes in progress (including transactions), and the sequence counter. Read from ISRs.
+            uint8_t pm_writing = 0;
+            uint8_t volatile pm_sequence = 0;
+
+            //Extends the range of modified bytes to include len bytes at pos
+            void extend_dirty(size_t const pos, size_t const len);
+            //Defers the write callback for len bytes at pos until commit()
+            void defer_callback(size_t const pos, size_t const len);
+            //Calls the write callback for the deferred range, if any
+            void flush_callback();
+
             /// Called before any read or write operation to check for out-of-bounds conditions.
             inline bool invalidTransfer(size_t const pos, size_t const len) const;
         };
@@ -464,6 +987,16 @@ namespace libmodule
         class StaticBuffer : public Buffer
         {
         public:
+            ///Writes \p value to the register described by \p field_t, which is checked to be in bounds at compile time.
+            template <typename field_t>
+            void set(typename field_t::type const &value);
+            ///Reads the register described by \p field_t, which is checked to be in bounds at compile time.
+            template <typename field_t>
+            typename field_t::type get() const;
+            ///\copybrief Buffer::get_snapshot() The register is checked to be in bounds at compile time.
+            template <typename field_t>
+            typename field_t::type get_snapshot() const;
+
             ///Constructor.
             StaticBuffer();
         protected:
@@ -473,6 +1006,143 @@ namespace libmodule
     } //utility
 } //libmodule
 
+#ifdef LIBMODULE_ATOMIC_STATS
+/** Sites are only ever added to the end of the list, so each site is visited once. A site entered for the first time during the walk may not be visited.
+ * \n \p func is called outside of the critical section, so it can take as long as needed (e.g. to print the site).
+ * \tparam func_t [implicit] Callable with the signature `void(AtomicSite const &)`.
+ * \param [in] func Called for each site.
+ */
+template <typename func_t>
+void libmodule::utility::atomic_stats_for_each(func_t func)
+{
+    AtomicSite copy(nullptr, 0);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if(atomic_stats_head == nullptr) return;
+        copy = *atomic_stats_head;
+    }
+    while(true) {
+        func(static_cast<AtomicSite const &>(copy));
+        if(copy.next == nullptr) {
+            return;
+        }
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            copy = *copy.next;
+        }
+    }
+}
+#endif
+
+template <typename T>
+T libmodule::utility::Atomic<T>::load() const
+{
+#ifdef LIBMODULE_HOST
+    return pm_value.load();
+#else
+    T rtrn = pm_value;
+    if(sizeof(T) > 1) {
+        T check;
+        while((check = pm_value) != rtrn)
+            rtrn = check;
+    }
+    return rtrn;
+#endif
+}
+
+template <typename T>
+void libmodule::utility::Atomic<T>::store(T const value)
+{
+#ifdef LIBMODULE_HOST
+    pm_value.store(value);
+#else
+    if(sizeof(T) == 1) {
+        pm_value = value;
+        return;
+    }
+    LM_ATOMIC_BLOCK() {
+        pm_value = value;
+    }
+#endif
+}
+
+template <typename T>
+T libmodule::utility::Atomic<T>::exchange(T const value)
+{
+#ifdef LIBMODULE_HOST
+    return pm_value.exchange(value);
+#else
+    T rtrn;
+    LM_ATOMIC_BLOCK() {
+        rtrn = pm_value;
+        pm_value = value;
+    }
+    return rtrn;
+#endif
+}
+
+template <typename T>
+T libmodule::utility::Atomic<T>::fetch_add(T const value)
+{
+#ifdef LIBMODULE_HOST
+    return pm_value.fetch_add(value);
+#else
+    T rtrn;
+    LM_ATOMIC_BLOCK() {
+        rtrn = pm_value;
+        pm_value = rtrn + value;
+    }
+    return rtrn;
+#endif
+}
+
+template <typename T>
+T libmodule::utility::Atomic<T>::fetch_sub(T const value)
+{
+#ifdef LIBMODULE_HOST
+    return pm_value.fetch_sub(value);
+#else
+    T rtrn;
+    LM_ATOMIC_BLOCK() {
+        rtrn = pm_value;
+        pm_value = rtrn - value;
+    }
+    return rtrn;
+#endif
+}
+
+template <typename T>
+libmodule::utility::Atomic<T>::operator T() const
+{
+    return load();
+}
+
+template <typename T>
+libmodule::utility::Atomic<T> &libmodule::utility::Atomic<T>::operator=(T const value)
+{
+    store(value);
+    return *this;
+}
+
+/** The check for trivially copyable is a constant, so only one of the paths is compiled in.
+ */
+template <typename T>
+void libmodule::utility::relocate(T *const dst, T *const src, size_t const len)
+{
+    if(is_trivially_copyable<T>::value) {
+        memmove(static_cast<void *>(dst), static_cast<void const *>(src), sizeof(T) * len);
+    } else if(dst < src) {
+        //Moving toward the start, so go from the start (each destination is free by the time it is used)
+        for(size_t i = 0; i < len; i++) {
+            new(dst + i) T(utility::move(src[i]));
+            src[i].~T();
+        }
+    } else if(dst > src) {
+        for(size_t i = len; i > 0; i--) {
+            new(dst + i - 1) T(utility::move(src[i - 1]));
+            src[i - 1].~T();
+        }
+    }
+}
+
 //Could have the names in the second comment line be links. See also formatting could be different.
 /** Adds \p p to the end (past the greatest position index) of the vector. A copy of \p p is stored.
  * \n Equivalent to #insert(\p p, \a #count).
@@ -486,9 +1156,75 @@ void libmodule::utility::Vector<T, count_t>::push_back(T const &p)
     insert(p, count);
 }
 
+/** This member function is enclosed in an `ATOMIC_BLOCK`.
+ * \n The element is created using `T`'s move constructor. If memory allocation fails, hw::panic() is called.
+ * \note Invalidates references to elements.
+ * \param [in] p Element to move from.
+ */
+template <typename T, typename count_t /*= uint8_t*/>
+void libmodule::utility::Vector<T, count_t>::push_back(T &&p)
+{
+    LM_ATOMIC_BLOCK() {
+        new(insert_space(count)) T(utility::move(p));
+        count++;
+    }
+}
+
+/** This member function is enclosed in an `ATOMIC_BLOCK`.
+ * \n The element is constructed in place, so no copy is made. If memory allocation fails, hw::panic() is called.
+ * \note Invalidates references to elements.
+ * \tparam args_t [implicit] Types of the constructor arguments.
+ * \param [in] args Arguments passed to `T`'s constructor.
+ */
+template <typename T, typename count_t /*= uint8_t*/>
+template <typename ...args_t>
+void libmodule::utility::Vector<T, count_t>::emplace_back(args_t &&...args)
+{
+    LM_ATOMIC_BLOCK() {
+        new(insert_space(count)) T(utility::forward<args_t>(args)...);
+        count++;
+    }
+}
+
+/** This member function is enclosed in an `ATOMIC_BLOCK`.
+ * \n The current elements are destructed, then memory is allocated at most once for the new elements. They are created using `T`'s copy constructor.
+ * \n If memory allocation fails, hw::panic() is called.
+ * \note Invalidates references to elements. \p src must not point into this vector.
+ * \param [in] src Elements to copy.
+ * \param [in] len Number of elements at \p src.
+ */
+template <typename T, typename count_t /*= uint8_t*/>
+void libmodule::utility::Vector<T, count_t>::assign(T const *const src, count_t const len)
+{
+    LM_ATOMIC_BLOCK() {
+        resize(0);
+        append(src, len);
+    }
+}
+
+/** This member function is enclosed in an `ATOMIC_BLOCK`.
+ * \n Memory is allocated at most once (growing the capacity as for insert()). Elements are created using `T`'s copy constructor.
+ * \n If the vector would be too large or memory allocation fails, hw::panic() is called.
+ * \note Invalidates references to elements. \p src must not point into this vector.
+ * \param [in] src Elements to copy.
+ * \param [in] len Number of elements at \p src.
+ */
+template <typename T, typename count_t /*= uint8_t*/>
+void libmodule::utility::Vector<T, count_t>::append(T const *const src, count_t const len)
+{
+    LM_ATOMIC_BLOCK() {
+        grow(static_cast<size_t>(count) + len);
+        for(count_t i = 0; i < len; i++) {
+            new(&(data[count + i])) T(src[i]);
+        }
+        count += len;
+    }
+}
+
 /** This member function is enclosed in an `ATOMIC_BLOCK`.
  * \n If an element is already in \p pos, it and all following elements are moved one position toward the end.
- * \n If \p pos is out of range (greater than \a #count) or memory allocation fails, hw::panic() is called.
+ * \n If \p pos is out of range (greater than \a #count), the vector is full, or memory allocation fails, hw::panic() is called.
+ * \n Memory is only reallocated when there is no space left, see #capacity().
  * \n A copy of the element is created using `T`'s copy constructor.
  * \note Invalidates references to elements.
  * \param [in] p Element to insert.
@@ -497,22 +1233,10 @@ void libmodule::utility::Vector<T, count_t>::push_back(T const &p)
 template <typename T, typename count_t /*= uint8_t*/>
 void libmodule::utility::Vector<T, count_t>::insert(T const &p, count_t const pos)
 {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        //Cannot insert at end + 1
-        if(pos > count) hw::panic();
-        //If memory is not allocated (size is 0)
-        if(count == 0 && data == nullptr) {
-            data = static_cast<T *>(malloc(sizeof(T)));
-            count++;
-        } else {
-            //Reallocate memory with space for the new element
-            data = static_cast<T *>(realloc(static_cast<void *>(data), sizeof(T) * ++count));
-        }
-        if(data == nullptr) hw::panic();
-        //Move the following elements out of the way
-        memmove(data + pos + 1, data + pos, sizeof(T) * (count - pos - 1));
+    LM_ATOMIC_BLOCK() {
         //Construct element using placement-new and copy-constructor
-        new(&(data[pos])) T(p);
+        new(insert_space(pos)) T(p);
+        count++;
     }
 }
 
@@ -525,58 +1249,48 @@ void libmodule::utility::Vector<T, count_t>::insert(T const &p, count_t const po
 template <typename T, typename count_t /*= uint8_t*/>
 void libmodule::utility::Vector<T, count_t>::remove(T const &p)
 {
-    //Remove all elements that match
-    for(count_t i = 0; i < count; i++) {
-        if(p == data[i]) remove_pos(i);
+    //Remove all elements that match. The element after a removed one moves into its position, so only advance when nothing was removed.
+    for(count_t i = 0; i < count;) {
+        if(p == data[i])
+            remove_pos(i);
+        else
+            i++;
     }
 }
 
 /** This member function is enclosed in an `ATOMIC_BLOCK`.
  * \n `T`s destructor is called on the element before it is deleted.
- * \n If \p pos is not in range or memory allocation fails, hw::panic() is called.
+ * \n The memory is kept for later insertions (see shrink_to_fit()), so this doesn't allocate.
+ * \n If \p pos is not in range, hw::panic() is called.
  * \note Invalidates reference to elements.
  * \param [in] pos Position of element to remove.
  */
 template <typename T, typename count_t /*= uint8_t*/>
 void libmodule::utility::Vector<T, count_t>::remove_pos(count_t const pos)
 {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    LM_ATOMIC_BLOCK() {
         //Deallocate the element at pos
         if(pos >= count) hw::panic();
         data[pos].~T();
-        //If now empty, free memory
-        if(--count == 0) {
-            free(data);
-            data = nullptr;
-        } else {
-            //Move the memory on top of the element to fill in the gap
-            if(memmove(data + pos, data + pos + 1, sizeof(T) * (count - pos)) == nullptr) hw::panic();
-            //Reallocate memory without the old element
-            data = static_cast<T *>(realloc(static_cast<void *>(data), sizeof(T) * count));
-            //Check for realloc error
-            if(data == nullptr) hw::panic();
-        }
+        //Move the following elements on top of the element to fill in the gap
+        relocate(data + pos, data + pos + 1, --count - pos);
     }
 }
 
 /** This member function is enclosed in an `ATOMIC_BLOCK`.
  * \n If the new size is greater than the current size, elements are default constructed on the end of the vector.
- * \n If the new size is smaller than the current size, elements are destructed from the end of the vector.
- * \n If memory allocation fails, hw::panic() is called.
+ * \n If the new size is smaller than the current size, elements are destructed from the end of the vector. The memory is kept (see shrink_to_fit()).
+ * \n When growing past the capacity, the capacity becomes exactly \p size. If memory allocation fails, hw::panic() is called.
  * \note Invalidates references to elements if size changes.
  * \param [in] size Number of elements the vector should hold.
  */
 template <typename T, typename count_t /*= uint8_t*/>
 void libmodule::utility::Vector<T, count_t>::resize(count_t const size)
 {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    LM_ATOMIC_BLOCK() {
         if(size > count) {
-            //If memory is not allocated
-            if(count == 0 && data == nullptr)
-                data = static_cast<T *>(malloc(sizeof(T) * size));
-            else
-                data = static_cast<T *>(realloc(static_cast<void *>(data), sizeof(T) * size));
-            if(data == nullptr) hw::panic();
+            if(size > reserved)
+                reallocate(size);
             //Default initialize objects
             for(count_t i = count; i < size; i++) {
                 new(&(data[i])) T;
@@ -587,34 +1301,62 @@ void libmodule::utility::Vector<T, count_t>::resize(count_t const size)
             for(count_t i = size; i < count; i++) {
                 data[i].~T();
             }
-            //If now empty, free memory
-            if(size == 0) {
-                free(data);
-                data = nullptr;
-            } else {
-                //Resize memory
-                data = static_cast<T *>(realloc(static_cast<void *>(data), sizeof(T) * size));
-                if(data == nullptr) hw::panic();
-            }
             count = size;
         }
     }
 }
 
+/** This member function is enclosed in an `ATOMIC_BLOCK`.
+ * \n Does nothing if there is already space for \p size elements. Otherwise the capacity becomes exactly \p size.
+ * \n If memory allocation fails, hw::panic() is called.
+ * \note Invalidates references to elements if memory is reallocated.
+ * \param [in] size Number of elements to make space for.
+ */
+template <typename T, typename count_t /*= uint8_t*/>
+void libmodule::utility::Vector<T, count_t>::reserve(count_t const size)
+{
+    LM_ATOMIC_BLOCK() {
+        if(size > reserved)
+            reallocate(size);
+    }
+}
+
+/** This member function is enclosed in an `ATOMIC_BLOCK`.
+ * \n If the vector is empty, the memory is freed.
+ * \n If memory allocation fails, hw::panic() is called.
+ * \note Invalidates references to elements if memory is reallocated.
+ */
+template <typename T, typename count_t /*= uint8_t*/>
+void libmodule::utility::Vector<T, count_t>::shrink_to_fit()
+{
+    LM_ATOMIC_BLOCK() {
+        if(reserved > count)
+            reallocate(count);
+    }
+}
+
 template <typename T, typename count_t /*= uint8_t*/>
 count_t libmodule::utility::Vector<T, count_t>::size() const
 {
     return count;
 }
 
-/** If \p pos is out of bounds, hw::panic() is called.
+template <typename T, typename count_t /*= uint8_t*/>
+count_t libmodule::utility::Vector<T, count_t>::capacity() const
+{
+    return reserved;
+}
+
+/** If \p pos is out of bounds and \c LIBMODULE_BOUNDS_CHECK is \c 1, hw::panic() is called.
  * \param [in] pos Position of element to access.
  * \return Reference to element at \p pos.
  */
 template <typename T, typename count_t /*= uint8_t*/>
 T &libmodule::utility::Vector<T, count_t>::operator[](count_t const pos)
 {
+#if LIBMODULE_BOUNDS_CHECK
     if(pos >= count) hw::panic();
+#endif
     return data[pos];
 }
 
@@ -623,38 +1365,57 @@ T &libmodule::utility::Vector<T, count_t>::operator[](count_t const pos)
 template <typename T, typename count_t /*= uint8_t*/>
 T const &libmodule::utility::Vector<T, count_t>::operator[](count_t const pos) const
 {
+#if LIBMODULE_BOUNDS_CHECK
     if(pos >= count) hw::panic();
+#endif
     return data[pos];
 }
 
+/** \note Invalidated in the same way as references to elements.
+ */
+template <typename T, typename count_t /*= uint8_t*/>
+T *libmodule::utility::Vector<T, count_t>::begin()
+{
+    return data;
+}
+
+template <typename T, typename count_t /*= uint8_t*/>
+T const *libmodule::utility::Vector<T, count_t>::begin() const
+{
+    return data;
+}
+
+template <typename T, typename count_t /*= uint8_t*/>
+T *libmodule::utility::Vector<T, count_t>::end()
+{
+    return data + count;
+}
+
+template <typename T, typename count_t /*= uint8_t*/>
+T const *libmodule::utility::Vector<T, count_t>::end() const
+{
+    return data + count;
+}
+
 /** This member function is enclosed in an `ATOMIC_BLOCK`.
- * \n Elements are copied using `T`'s copy constructor.
+ * \n Elements are copied using `T`'s copy constructor. The capacity is the size of \p p.
  * \n If memory allocation fails, hw::panic() is called.
  * \param [in] p Vector to copy.
  */
 template <typename T, typename count_t /*= uint8_t*/>
-libmodule::utility::Vector<T, count_t>::Vector(Vector const &p) : count(p.count)
+libmodule::utility::Vector<T, count_t>::Vector(Vector const &p)
 {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        if(count > 0) {
-            //Allocate new memory
-            data = static_cast<T *>(malloc(sizeof(T) * count));
-            if(data == nullptr) hw::panic();
-            //Copy construct objects from p
-            for(count_t i = 0; i < count; i++) {
-                new(&(data[i])) T(p.data[i]);
-            }
-        }
-    }
+    assign(p.data, p.count);
 }
-/** \p p has \a #data set to \c nullptr and \a #count set to \c 0.
+/** \p p has \a #data set to \c nullptr, and \a #count and \a #reserved set to \c 0.
  * \param [in,out] p Source vector.
  */
 template <typename T, typename count_t /*= uint8_t*/>
-libmodule::utility::Vector<T, count_t>::Vector(Vector &&p) : data(p.data), count(p.count)
+libmodule::utility::Vector<T, count_t>::Vector(Vector &&p) : data(p.data), count(p.count), reserved(p.reserved)
 {
     p.data = nullptr;
     p.count = 0;
+    p.reserved = 0;
 }
 
 /** Calls #resize(\c size). New elements are default constructed.
@@ -667,30 +1428,447 @@ libmodule::utility::Vector<T, count_t>::Vector(count_t const size)
     resize(size);
 }
 
-/** Calls #resize(\c 0).
+/** Calls #resize(\c 0), then frees the memory.
  * \sa Vector::resize
  */
 template <typename T, typename count_t /*= uint8_t*/>
 libmodule::utility::Vector<T, count_t>::~Vector()
 {
     resize(0);
+    shrink_to_fit();
+}
+
+/** The new capacity is \p size, or half as much again as the current capacity if that is larger (limited to the largest \c count_t).
+ * \n If \p size is larger than the largest \c count_t, hw::panic() is called.
+ */
+template <typename T, typename count_t /*= uint8_t*/>
+void libmodule::utility::Vector<T, count_t>::grow(size_t const size)
+{
+    constexpr count_t max = static_cast<count_t>(~static_cast<count_t>(0));
+    if(size <= reserved)
+        return;
+    if(size > max) hw::panic();
+    size_t const next = static_cast<size_t>(reserved) + reserved / 2;
+    reallocate(next > size ? (next > max ? max : next) : size);
+}
+
+/** If \c T is trivially copyable, pool_realloc() is used (which moves the elements bitwise).
+ * Otherwise a new block is allocated, and the elements are moved into it with relocate().
+ * \n If memory allocation fails, hw::panic() is called.
+ */
+template <typename T, typename count_t /*= uint8_t*/>
+void libmodule::utility::Vector<T, count_t>::reallocate(count_t const size)
+{
+    if(size == 0) {
+        pool_free(data);
+        data = nullptr;
+    } else if(is_trivially_copyable<T>::value) {
+        data = static_cast<T *>(pool_realloc(static_cast<void *>(data), sizeof(T) * size));
+        if(data == nullptr) hw::panic();
+    } else {
+        T *const block = static_cast<T *>(pool_alloc(sizeof(T) * size));
+        if(block == nullptr) hw::panic();
+        relocate(block, data, count);
+        pool_free(data);
+        data = block;
+    }
+    reserved = size;
+}
+
+/** If \p pos is out of range (greater than \a #count) or the vector is full, hw::panic() is called.
+ * \n The following elements are moved one position toward the end. \a #count is not changed.
+ */
+template <typename T, typename count_t /*= uint8_t*/>
+T *libmodule::utility::Vector<T, count_t>::insert_space(count_t const pos)
+{
+    //Cannot insert at end + 1
+    if(pos > count) hw::panic();
+    grow(count + 1);
+    //Move the following elements out of the way
+    relocate(data + pos + 1, data + pos, count - pos);
+    return data + pos;
+}
+
+/** Equivalent to #insert(\p p, \a #count).
+ * \param [in] p Element to add.
+ * \sa StaticVector::insert
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+void libmodule::utility::StaticVector<T, capacity_c, count_t>::push_back(T const &p)
+{
+    insert(p, count);
+}
+
+/** The element is created using `T`'s move constructor. If the vector is full, hw::panic() is called.
+ * \param [in] p Element to move from.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+void libmodule::utility::StaticVector<T, capacity_c, count_t>::push_back(T &&p)
+{
+    new(insert_space(count)) T(utility::move(p));
+    count++;
+}
+
+/** The element is constructed in place. If the vector is full, hw::panic() is called.
+ * \tparam args_t [implicit] Types of the constructor arguments.
+ * \param [in] args Arguments passed to `T`'s constructor.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+template <typename ...args_t>
+void libmodule::utility::StaticVector<T, capacity_c, count_t>::emplace_back(args_t &&...args)
+{
+    new(insert_space(count)) T(utility::forward<args_t>(args)...);
+    count++;
+}
+
+/** If \p pos is out of range (greater than \a #count) or the vector is full, hw::panic() is called.
+ * \n The following elements are moved one position toward the end. A copy of the element is created using `T`'s copy constructor.
+ * \param [in] p Element to insert.
+ * \param [in] pos Position to insert element.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+void libmodule::utility::StaticVector<T, capacity_c, count_t>::insert(T const &p, count_t const pos)
+{
+    new(insert_space(pos)) T(p);
+    count++;
+}
+
+/** \p p is compared to the elements using `operator ==`. All elements matching \p p are removed.
+ * \param [in] p Object equal to those being removed.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+void libmodule::utility::StaticVector<T, capacity_c, count_t>::remove(T const &p)
+{
+    for(count_t i = 0; i < count;) {
+        if(p == pm_items[i])
+            remove_pos(i);
+        else
+            i++;
+    }
+}
+
+/** `T`s destructor is called on the element before it is removed.
+ * \n If \p pos is not in range, hw::panic() is called.
+ * \param [in] pos Position of element to remove.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+void libmodule::utility::StaticVector<T, capacity_c, count_t>::remove_pos(count_t const pos)
+{
+    if(pos >= count) hw::panic();
+    pm_items[pos].~T();
+    relocate(pm_items + pos, pm_items + pos + 1, --count - pos);
+}
+
+/** Elements are default constructed onto, or destructed from, the end.
+ * \n If \p size is greater than \p capacity_c, hw::panic() is called.
+ * \param [in] size Number of elements the vector should hold.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+void libmodule::utility::StaticVector<T, capacity_c, count_t>::resize(count_t const size)
+{
+    if(size > capacity_c) hw::panic();
+    for(; count < size; count++) {
+        new(&(pm_items[count])) T;
+    }
+    for(; count > size; count--) {
+        pm_items[count - 1].~T();
+    }
+}
+
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+count_t libmodule::utility::StaticVector<T, capacity_c, count_t>::size() const
+{
+    return count;
+}
+
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+constexpr count_t libmodule::utility::StaticVector<T, capacity_c, count_t>::capacity()
+{
+    return capacity_c;
+}
+
+/** If \p pos is out of bounds and \c LIBMODULE_BOUNDS_CHECK is \c 1, hw::panic() is called.
+ * \param [in] pos Position of element to access.
+ * \return Reference to element at \p pos.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+T &libmodule::utility::StaticVector<T, capacity_c, count_t>::operator[](count_t const pos)
+{
+#if LIBMODULE_BOUNDS_CHECK
+    if(pos >= count) hw::panic();
+#endif
+    return pm_items[pos];
+}
+
+/** \return This reference is \c const.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+T const &libmodule::utility::StaticVector<T, capacity_c, count_t>::operator[](count_t const pos) const
+{
+#if LIBMODULE_BOUNDS_CHECK
+    if(pos >= count) hw::panic();
+#endif
+    return pm_items[pos];
+}
+
+/** \note Invalidated in the same way as references to elements.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+T *libmodule::utility::StaticVector<T, capacity_c, count_t>::begin()
+{
+    return pm_items;
+}
+
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+T const *libmodule::utility::StaticVector<T, capacity_c, count_t>::begin() const
+{
+    return pm_items;
+}
+
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+T *libmodule::utility::StaticVector<T, capacity_c, count_t>::end()
+{
+    return pm_items + count;
+}
+
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+T const *libmodule::utility::StaticVector<T, capacity_c, count_t>::end() const
+{
+    return pm_items + count;
+}
+
+/** Elements are copied using `T`'s copy constructor.
+ * \param [in] p Vector to copy.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+libmodule::utility::StaticVector<T, capacity_c, count_t>::StaticVector(StaticVector const &p)
+{
+    for(; count < p.count; count++) {
+        new(&(pm_items[count])) T(p.pm_items[count]);
+    }
+}
+
+/** Calls #resize(\c size).
+ * \param [in] size Number of elements the vector should hold.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+libmodule::utility::StaticVector<T, capacity_c, count_t>::StaticVector(count_t const size)
+{
+    resize(size);
+}
+
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+libmodule::utility::StaticVector<T, capacity_c, count_t>::~StaticVector()
+{
+    resize(0);
+}
+
+/** If \p pos is out of range (greater than \a #count) or the vector is full, hw::panic() is called.
+ * \n The following elements are moved one position toward the end. \a #count is not changed.
+ */
+template <typename T, size_t capacity_c, typename count_t /*= uint8_t*/>
+T *libmodule::utility::StaticVector<T, capacity_c, count_t>::insert_space(count_t const pos)
+{
+    if(pos > count || count >= capacity_c) hw::panic();
+    relocate(pm_items + pos + 1, pm_items + pos, count - pos);
+    return pm_items + pos;
+}
+
+/** The element is copied in before the head index is published (with release ordering), so the consumer never sees an index for an element that isn't there yet.
+ * \param [in] item Element to add.
+ * \return Whether the element was added.
+ */
+template <typename T, uint8_t capacity_c>
+bool libmodule::utility::SpscQueue<T, capacity_c>::push(T const &item)
+{
+    uint8_t const head = pm_head;
+    if(static_cast<uint8_t>(head - __atomic_load_n(&pm_tail, __ATOMIC_ACQUIRE)) >= capacity_c) {
+        add_overflows(1);
+        return false;
+    }
+    pm_items[head & (capacity_c - 1)] = item;
+    __atomic_store_n(&pm_head, static_cast<uint8_t>(head + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+/** The head index is published once, after all the elements are copied in, so the consumer sees them together.
+ * \param [in] items Elements to add.
+ * \param [in] len Number of elements in \p items.
+ * \return Number of elements added.
+ */
+template <typename T, uint8_t capacity_c>
+uint8_t libmodule::utility::SpscQueue<T, capacity_c>::push(T const items[], uint8_t const len)
+{
+    uint8_t const head = pm_head;
+    uint8_t const space = capacity_c - static_cast<uint8_t>(head - __atomic_load_n(&pm_tail, __ATOMIC_ACQUIRE));
+    uint8_t const rtrn = tmin(space, len);
+    for(uint8_t i = 0; i < rtrn; i++)
+        pm_items[(head + i) & (capacity_c - 1)] = items[i];
+    __atomic_store_n(&pm_head, static_cast<uint8_t>(head + rtrn), __ATOMIC_RELEASE);
+    if(rtrn < len)
+        add_overflows(len - rtrn);
+    return rtrn;
+}
+
+/** \param [out] item Destination for the element removed.
+ * \return Whether an element was removed.
+ */
+template <typename T, uint8_t capacity_c>
+bool libmodule::utility::SpscQueue<T, capacity_c>::pop(T &item)
+{
+    uint8_t const tail = pm_tail;
+    if(__atomic_load_n(&pm_head, __ATOMIC_ACQUIRE) == tail)
+        return false;
+    item = pm_items[tail & (capacity_c - 1)];
+    __atomic_store_n(&pm_tail, static_cast<uint8_t>(tail + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+/** \param [out] items Destination for the elements removed.
+ * \param [in] len Maximum number of elements to remove.
+ * \return Number of elements removed.
+ */
+template <typename T, uint8_t capacity_c>
+uint8_t libmodule::utility::SpscQueue<T, capacity_c>::pop(T items[], uint8_t const len)
+{
+    uint8_t const tail = pm_tail;
+    uint8_t const rtrn = tmin(static_cast<uint8_t>(__atomic_load_n(&pm_head, __ATOMIC_ACQUIRE) - tail), len);
+    for(uint8_t i = 0; i < rtrn; i++)
+        items[i] = pm_items[(tail + i) & (capacity_c - 1)];
+    __atomic_store_n(&pm_tail, static_cast<uint8_t>(tail + rtrn), __ATOMIC_RELEASE);
+    return rtrn;
+}
+
+template <typename T, uint8_t capacity_c>
+void libmodule::utility::SpscQueue<T, capacity_c>::clear()
+{
+    __atomic_store_n(&pm_tail, __atomic_load_n(&pm_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+/** As the other context may change the queue at any time, this is only a snapshot.
+ * It can only be too low when called by the consumer, and too high when called by the producer, so it is safe to act on from either.
+ */
+template <typename T, uint8_t capacity_c>
+uint8_t libmodule::utility::SpscQueue<T, capacity_c>::size() const
+{
+    return __atomic_load_n(&pm_head, __ATOMIC_ACQUIRE) - __atomic_load_n(&pm_tail, __ATOMIC_ACQUIRE);
+}
+
+template <typename T, uint8_t capacity_c>
+bool libmodule::utility::SpscQueue<T, capacity_c>::empty() const
+{
+    return size() == 0;
+}
+
+template <typename T, uint8_t capacity_c>
+bool libmodule::utility::SpscQueue<T, capacity_c>::full() const
+{
+    return size() >= capacity_c;
+}
+
+template <typename T, uint8_t capacity_c>
+constexpr uint8_t libmodule::utility::SpscQueue<T, capacity_c>::capacity()
+{
+    return capacity_c;
+}
+
+/** The counter is two bytes, so it is read until two reads agree, rather than disabling interrupts. Only the producer writes it, and it can't be interrupted by the reader if the reader is the main loop.
+ */
+template <typename T, uint8_t capacity_c>
+uint16_t libmodule::utility::SpscQueue<T, capacity_c>::overflows() const
+{
+    uint16_t rtrn;
+    do {
+        rtrn = pm_overflows;
+    } while(rtrn != pm_overflows);
+    return rtrn;
+}
+
+template <typename T, uint8_t capacity_c>
+void libmodule::utility::SpscQueue<T, capacity_c>::add_overflows(uint8_t const len)
+{
+    uint16_t const overflows = pm_overflows;
+    pm_overflows = overflows > UINT16_MAX - len ? UINT16_MAX : overflows + len;
+}
+
+template<typename T, typename count_t /*= uint8_t*/>
+T *libmodule::utility::InstanceList<T, count_t>::il_first()
+{
+    return static_cast<T *>(il_head);
+}
+
+template<typename T, typename count_t /*= uint8_t*/>
+T *libmodule::utility::InstanceList<T, count_t>::il_next() const
+{
+    return static_cast<T *>(il_next_instance);
+}
+
+template<typename T, typename count_t /*= uint8_t*/>
+count_t libmodule::utility::InstanceList<T, count_t>::il_size()
+{
+    return il_count;
+}
+
+/** See \ref InstanceList for when this is safe to call.
+ * \tparam func_t [implicit] Callable type taking a `T *`.
+ * \param [in] func Function to call.
+ */
+template<typename T, typename count_t /*= uint8_t*/>
+template <typename func_t>
+void libmodule::utility::InstanceList<T, count_t>::il_for_each(func_t func)
+{
+    for(InstanceList *instance = il_head; instance != nullptr;) {
+        //Read first, as func may destruct instance
+        InstanceList *const next = instance->il_next_instance;
+        func(static_cast<T *>(instance));
+        instance = next;
+    }
 }
 
 /** This member function is enclosed in an `ATOMIC_BLOCK`.
  */
-template<typename T, typename count_t>
+template<typename T, typename count_t /*= uint8_t*/>
 libmodule::utility::InstanceList<T, count_t>::InstanceList()
 {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        il_instances.push_back(static_cast<T *>(this));
-    }
+    il_insert();
 }
 
+/** This member function is enclosed in an `ATOMIC_BLOCK`.
+ */
+template<typename T, typename count_t /*= uint8_t*/>
+libmodule::utility::InstanceList<T, count_t>::InstanceList(InstanceList const &)
+{
+    il_insert();
+}
+
+/** Each object keeps its own place in the list.
+ */
+template<typename T, typename count_t /*= uint8_t*/>
+libmodule::utility::InstanceList<T, count_t> &libmodule::utility::InstanceList<T, count_t>::operator=(InstanceList const &)
+{
+    return *this;
+}
+
+/** This member function is enclosed in an `ATOMIC_BLOCK`.
+ */
 template<typename T, typename count_t /*= uint8_t*/>
 libmodule::utility::InstanceList<T, count_t>::~InstanceList()
 {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        il_instances.remove(static_cast<T *>(this));
+    LM_ATOMIC_BLOCK() {
+        (il_prev_instance != nullptr ? il_prev_instance->il_next_instance : il_head) = il_next_instance;
+        (il_next_instance != nullptr ? il_next_instance->il_prev_instance : il_tail) = il_prev_instance;
+        il_count--;
+    }
+}
+
+template<typename T, typename count_t /*= uint8_t*/>
+void libmodule::utility::InstanceList<T, count_t>::il_insert()
+{
+    LM_ATOMIC_BLOCK() {
+        il_prev_instance = il_tail;
+        (il_tail != nullptr ? il_tail->il_next_instance : il_head) = this;
+        il_tail = this;
+        il_count++;
     }
 }
 
@@ -792,6 +1970,44 @@ T libmodule::utility::Buffer::serialiseRead(size_t const pos) const
     return rtrn;
 }
 
+/** For positions that are already known to be valid (e.g. from the layout in metadata.h), so that the write is only a copy.
+ * \n \a #pm_pos is not changed, and Callbacks::buffer_writeCallback is not called. The bytes are still marked as with mark_dirty().
+ * \n The copy and the marking are done in one critical section, so readers never see the write half done.
+ * \n If \c LIBMODULE_BOUNDS_CHECK is \c 1 and the write is out of bounds, hw::panic() is called.
+ * \tparam T [implicit] Type to write.
+ * \param [in] type Object to write.
+ * \param [in] pos The position offset from \a #pm_ptr for the write.
+ */
+template <typename T>
+void libmodule::utility::Buffer::serialiseWriteUnchecked(T const &type, size_t const pos)
+{
+#if LIBMODULE_BOUNDS_CHECK
+    if(pos > pm_len || pm_len - pos < sizeof(T)) hw::panic();
+#endif
+    LM_ATOMIC_BLOCK() {
+        memcpy(pm_ptr + pos, static_cast<void const *>(&type), sizeof(T));
+        mark_dirty_locked(pos, sizeof(T));
+    }
+}
+
+/** For positions that are already known to be valid, so that the read is only a copy.
+ * \n Callbacks::buffer_readCallback is not called.
+ * \n If \c LIBMODULE_BOUNDS_CHECK is \c 1 and the read is out of bounds, hw::panic() is called.
+ * \tparam T Type to read.
+ * \param [in] pos The position offset from \a #pm_ptr for the read.
+ * \return The object read.
+ */
+template <typename T>
+T libmodule::utility::Buffer::serialiseReadUnchecked(size_t const pos) const
+{
+#if LIBMODULE_BOUNDS_CHECK
+    if(pos > pm_len || pm_len - pos < sizeof(T)) hw::panic();
+#endif
+    T rtrn;
+    memcpy(static_cast<void *>(&rtrn), pm_ptr + pos, sizeof(T));
+    return rtrn;
+}
+
 /** Equivalent to \link serialiseRead<T>(T &, size_t const) serialiseRead\endlink(\p type, \a #pm_pos).
  * \tparam T Type to read into.
  * \param [out] type Object to read into.
@@ -814,6 +2030,97 @@ void libmodule::utility::Buffer::serialiseRead(T &type, size_t const pos)
     read(static_cast<void *>(&type), sizeof(T), pos);
 }
 
+/** Equivalent to \link serialiseWrite(T const &, size_t const) serialiseWrite\endlink(\p value, \c field_t::offset), so it is bounds checked and Callbacks::buffer_writeCallback is called.
+ * \n For loops where the position is already known to be valid, use #serialiseWriteUnchecked.
+ * \tparam field_t Register to write, e.g. `metadata::motorcontroller::field::MeasuredCurrent`.
+ * \param [in] value Value to write.
+ */
+template <typename field_t>
+void libmodule::utility::Buffer::set(typename field_t::type const &value)
+{
+    serialiseWrite(value, field_t::offset);
+}
+
+/** Equivalent to \link serialiseRead(size_t const) const serialiseRead\endlink<\c field_t::type>(\c field_t::offset), so it is bounds checked and Callbacks::buffer_readCallback is called.
+ * \tparam field_t Register to read, e.g. `metadata::motorcontroller::field::PWMFrequency`.
+ * \return Value of the register.
+ */
+template <typename field_t>
+typename field_t::type libmodule::utility::Buffer::get() const
+{
+    return serialiseRead<typename field_t::type>(field_t::offset);
+}
+
+/** For reading registers from the main loop that an ISR writes (e.g. registers written by the master in SlaveBufferManager::received()).
+ * \n The read is repeated until the sequence counter is the same before and after it, so the value isn't half old and half new. Interrupts are not disabled.
+ * \n An ISR can't wait for the main loop to finish writing, so it should use snapshot() instead.
+ * \n If the register is out of bounds, hw::panic() is called. Callbacks::buffer_readCallback is called once the read is consistent.
+ * \tparam field_t Register to read.
+ * \return Value of the register.
+ */
+template <typename field_t>
+typename field_t::type libmodule::utility::Buffer::get_snapshot() const
+{
+    if(field_t::end > pm_len)
+        hw::panic();
+    typename field_t::type rtrn;
+    uint8_t sequence;
+    do {
+        sequence = pm_sequence;
+        //Keep the copy between the two reads of pm_sequence
+        __asm__ __volatile__("" ::: "memory");
+        rtrn = serialiseReadUnchecked<typename field_t::type>(field_t::offset);
+        __asm__ __volatile__("" ::: "memory");
+    } while(sequence != pm_sequence);
+    read_callback(static_cast<void *>(&rtrn), sizeof(typename field_t::type), field_t::offset);
+    return rtrn;
+}
+
+/** As the position and size are constants, this is a single copy into \a #pm_buf, without a bounds check at runtime.
+ * \n The copy and the marking of the bytes (as with mark_dirty()) are done in one critical section.
+ * \n Otherwise it is the same as a write(): \a #pm_pos is updated, and Callbacks::buffer_writeCallback is called (or deferred, if in a transaction).
+ * \tparam field_t Register to write.
+ * \param [in] value Value to write.
+ */
+template<size_t len_c>
+template <typename field_t>
+void libmodule::utility::StaticBuffer<len_c>::set(typename field_t::type const &value)
+{
+    static_assert(field_t::end <= len_c, "Field is outside of the StaticBuffer");
+    LM_ATOMIC_BLOCK() {
+        memcpy(pm_buf + field_t::offset, static_cast<void const *>(&value), sizeof(typename field_t::type));
+        this->mark_dirty_locked(field_t::offset, sizeof(typename field_t::type));
+    }
+    this->write_callback(static_cast<void const *>(&value), sizeof(typename field_t::type), field_t::offset);
+}
+
+/** As the position and size are constants, this is a single copy from \a #pm_buf, without a bounds check at runtime.
+ * \n Callbacks::buffer_readCallback is called.
+ * \tparam field_t Register to read.
+ * \return Value of the register.
+ */
+template<size_t len_c>
+template <typename field_t>
+typename field_t::type libmodule::utility::StaticBuffer<len_c>::get() const
+{
+    static_assert(field_t::end <= len_c, "Field is outside of the StaticBuffer");
+    typename field_t::type rtrn;
+    memcpy(static_cast<void *>(&rtrn), pm_buf + field_t::offset, sizeof(typename field_t::type));
+    this->read_callback(static_cast<void *>(&rtrn), sizeof(typename field_t::type), field_t::offset);
+    return rtrn;
+}
+
+/** \tparam field_t Register to read.
+ * \return Value of the register.
+ */
+template<size_t len_c>
+template <typename field_t>
+typename field_t::type libmodule::utility::StaticBuffer<len_c>::get_snapshot() const
+{
+    static_assert(field_t::end <= len_c, "Field is outside of the StaticBuffer");
+    return Buffer::get_snapshot<field_t>();
+}
+
 /** Sets \a Buffer::pm_ptr to \a #pm_buf and \a Buffer::pm_len to \c len_c using Buffer::Buffer.
  */
 template<size_t len_c>